@@ -0,0 +1,198 @@
+#include "Camera.hpp"
+#include "utility/PtrChain.hpp"
+#include "utility/Memory.hpp"
+#include "utility/Log.hpp"
+#include <cmath>
+#include <algorithm>
+#include <xmmintrin.h>
+
+Camera::Camera() : pLocalPlayerStaticPtr(nullptr), pov(), fViewportSize(), viewProjection(), bIsValid(false)
+{
+}
+
+Camera::~Camera()
+{
+}
+
+bool Camera::Initialize(char* pLocalPlayerSig)
+{
+	if (pLocalPlayerSig == nullptr)
+	{
+		LOG_WARNING("Failed to find LocalPlayer signature");
+		return false;
+	}
+
+	char* ptr = pLocalPlayerSig + LOCAL_PLAYER_SIG_OFFSET; // Move ptr to the mov operand
+	int offset = *(int*)ptr; // Read the offset of the static pointer
+	ptr = ptr + sizeof(int); // Move ptr to the next instruction (after mov)
+
+	pLocalPlayerStaticPtr = ptr + offset;
+
+	if (utility::IsBadReadPtr(pLocalPlayerStaticPtr))
+	{
+		LOG_WARNING("LocalPlayer static pointer is bad read");
+		pLocalPlayerStaticPtr = nullptr;
+		return false;
+	}
+
+	return true;
+}
+
+bool Camera::ReadPOV(POV& newPOV) const
+{
+	if (pLocalPlayerStaticPtr == nullptr)
+		return false;
+
+	// LocalPlayer -> PlayerController -> PlayerCameraManager -> CameraCachePrivate.POV
+	auto pov = utility::PtrChain<0x0, 0x30, 0x278, 0xF00>::Read<POV>(pLocalPlayerStaticPtr);
+	if (!pov)
+		return false;
+
+	newPOV = *pov;
+
+	return true;
+}
+
+bool Camera::Update(const POV& newPOV, float fViewportWidth, float fViewportHeight)
+{
+	bIsValid = false;
+
+	if (fViewportWidth < 1.0f || fViewportHeight < 1.0f || !std::isfinite(newPOV.fov) || !(newPOV.aspectRatio > 0.0f))
+		return false;
+
+	// The camera often stays still, don't rebuild the matrix for nothing
+	if (memcmp(&pov, &newPOV, sizeof(POV)) != 0 || fViewportSize[0] != fViewportWidth || fViewportSize[1] != fViewportHeight)
+	{
+		pov = newPOV;
+		fViewportSize[0] = fViewportWidth;
+		fViewportSize[1] = fViewportHeight;
+		BuildViewProjectionMatrix();
+	}
+
+	bIsValid = true;
+
+	return true;
+}
+
+void Camera::BuildViewProjectionMatrix()
+{
+	FMatrix viewRotationMatrix = FInverseRotationMatrix(FRotator(pov.rotation[0], pov.rotation[1], pov.rotation[2])) * FMatrix(
+		FPlane(0, 0, 1, 0),
+		FPlane(1, 0, 0, 0),
+		FPlane(0, 1, 0, 0),
+		FPlane(0, 0, 0, 1)
+	);
+
+	const float XAxisMultiplier = fViewportSize[1] / fViewportSize[0];
+	const float YAxisMultiplier = 1.0f;
+	const float HalfXFOV = FMath::DegreesToRadians(MAX(0.001f, pov.fov) / 2.f);
+	const float HalfYFOV = std::atan(std::tan(HalfXFOV) / pov.aspectRatio);
+
+	FMatrix projectionMatrix = FReversedZPerspectiveMatrix(
+		HalfYFOV,
+		HalfYFOV,
+		XAxisMultiplier,
+		YAxisMultiplier,
+		pov.orthoNearClipPlane,
+		pov.orthoFarClipPlane
+	);
+
+	viewProjection = FTranslationMatrix(-FVector(pov.location[0], pov.location[1], pov.location[2])) * viewRotationMatrix * projectionMatrix;
+}
+
+bool Camera::WorldToScreen(const FVector& worldPos, FVector2D& screenPos) const
+{
+	if (!bIsValid)
+		return false;
+
+	FPlane result = viewProjection.TransformFVector4(FVector4(worldPos, 1.0f));
+
+	// Same tests as the batched version, written so that NaNs from bad reads fail them too
+	const float limit = result.W * CLIP_SPACE_MARGIN;
+	if (!(result.W > 0.0f) || !(std::abs(result.X) <= limit) || !(std::abs(result.Y) <= limit))
+		return false;
+
+	const float RHW = 1.0f / result.W;
+
+	const float NormalizedX = (result.X * RHW / 2.f) + 0.5f;
+	const float NormalizedY = 1.f - (result.Y * RHW / 2.f) - 0.5f;
+
+	screenPos.X = NormalizedX * fViewportSize[0];
+	screenPos.Y = NormalizedY * fViewportSize[1];
+
+	return true;
+}
+
+size_t Camera::WorldToScreen(const FVector* pWorldPos, size_t count, FVector2D* pScreenPos, bool* pIsVisible) const
+{
+	if (!bIsValid)
+	{
+		memset(pIsVisible, 0, count * sizeof(bool));
+		return 0;
+	}
+
+	// Clip X, Y and W columns, Z is not needed with the reversed infinite far plane
+	const auto& M = viewProjection.M;
+	const __m128 m[4][3] =
+	{
+		{ _mm_set1_ps(M[0][0]), _mm_set1_ps(M[0][1]), _mm_set1_ps(M[0][3]) },
+		{ _mm_set1_ps(M[1][0]), _mm_set1_ps(M[1][1]), _mm_set1_ps(M[1][3]) },
+		{ _mm_set1_ps(M[2][0]), _mm_set1_ps(M[2][1]), _mm_set1_ps(M[2][3]) },
+		{ _mm_set1_ps(M[3][0]), _mm_set1_ps(M[3][1]), _mm_set1_ps(M[3][3]) },
+	};
+
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 signBit = _mm_set1_ps(-0.0f);
+	const __m128 margin = _mm_set1_ps(CLIP_SPACE_MARGIN);
+
+	// NDC to viewport, Y goes down on screen
+	const __m128 scaleX = _mm_set1_ps(fViewportSize[0] * 0.5f);
+	const __m128 scaleY = _mm_set1_ps(fViewportSize[1] * -0.5f);
+	const __m128 offsetX = _mm_set1_ps(fViewportSize[0] * 0.5f);
+	const __m128 offsetY = _mm_set1_ps(fViewportSize[1] * 0.5f);
+
+	alignas(16) float fScreenX[4];
+	alignas(16) float fScreenY[4];
+	size_t visibleCount = 0;
+
+	for (size_t i = 0; i < count; i += 4)
+	{
+		// The last block repeats the last position in its unused lanes
+		const size_t n = std::min<size_t>(count - i, 4);
+		const FVector* p[4] = { &pWorldPos[i], &pWorldPos[i + std::min<size_t>(1, n - 1)], &pWorldPos[i + std::min<size_t>(2, n - 1)], &pWorldPos[i + n - 1] };
+
+		const __m128 x = _mm_setr_ps(p[0]->X, p[1]->X, p[2]->X, p[3]->X);
+		const __m128 y = _mm_setr_ps(p[0]->Y, p[1]->Y, p[2]->Y, p[3]->Y);
+		const __m128 z = _mm_setr_ps(p[0]->Z, p[1]->Z, p[2]->Z, p[3]->Z);
+
+		const __m128 clipX = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m[0][0]), _mm_mul_ps(y, m[1][0])), _mm_add_ps(_mm_mul_ps(z, m[2][0]), m[3][0]));
+		const __m128 clipY = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m[0][1]), _mm_mul_ps(y, m[1][1])), _mm_add_ps(_mm_mul_ps(z, m[2][1]), m[3][1]));
+		const __m128 clipW = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m[0][2]), _mm_mul_ps(y, m[1][2])), _mm_add_ps(_mm_mul_ps(z, m[2][2]), m[3][2]));
+
+		// In front of the camera and inside the frustum sides, NaNs from bad reads fail every compare
+		const __m128 limit = _mm_mul_ps(clipW, margin);
+		__m128 visible = _mm_cmpgt_ps(clipW, zero);
+		visible = _mm_and_ps(visible, _mm_cmple_ps(_mm_andnot_ps(signBit, clipX), limit));
+		visible = _mm_and_ps(visible, _mm_cmple_ps(_mm_andnot_ps(signBit, clipY), limit));
+
+		// Rejected lanes divide by one instead of zero
+		const __m128 w = _mm_or_ps(_mm_and_ps(visible, clipW), _mm_andnot_ps(visible, one));
+		const __m128 rhw = _mm_div_ps(one, w);
+
+		_mm_store_ps(fScreenX, _mm_add_ps(_mm_mul_ps(_mm_mul_ps(clipX, rhw), scaleX), offsetX));
+		_mm_store_ps(fScreenY, _mm_add_ps(_mm_mul_ps(_mm_mul_ps(clipY, rhw), scaleY), offsetY));
+
+		const int mask = _mm_movemask_ps(visible);
+
+		for (size_t j = 0; j < n; ++j)
+		{
+			pScreenPos[i + j].X = fScreenX[j];
+			pScreenPos[i + j].Y = fScreenY[j];
+			pIsVisible[i + j] = (mask >> j) & 1;
+			visibleCount += pIsVisible[i + j];
+		}
+	}
+
+	return visibleCount;
+}
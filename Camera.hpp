@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <Windows.h>
+#include "Game/Matrix.h"
+#include "Game/Vector.h"
+#include "Game/Vector2D.h"
+#include "Game/Rotator.h"
+
+// FMinimalViewInfo of the camera manager, plain floats so it can be read as raw memory
+struct POV
+{
+	float location[3];
+	float rotation[3]; // Pitch, Yaw, Roll
+	float fov;
+	float desiredFOV;
+	float orthoWidth;
+	float orthoNearClipPlane;
+	float orthoFarClipPlane;
+	float aspectRatio;
+};
+
+// Reads the LocalPlayer static pointer, then its PlayerController (+0x30) and PlayerCameraManager (+0x278)
+static const short LOCAL_PLAYER_SIG[] =
+{
+	0x48, 0x8B, 0x05, -1, -1, -1, -1,
+	0x48, 0x85, 0xC0,
+	0x74, -1,
+	0x48, 0x8B, 0x40, 0x30,
+	0x48, 0x85, 0xC0,
+	0x74, -1,
+	0x48, 0x8B, 0x88, 0x78, 0x02, 0x00, 0x00,
+};
+
+static const size_t LOCAL_PLAYER_SIG_OFFSET = 0x3; // Offset of the static pointer, relative to the next instruction
+
+// Head tags inside this part of the clip space are projected, bars of the ones a bit offscreen are still partially visible
+static const float CLIP_SPACE_MARGIN = 1.1f;
+
+// The POV is read by the sampler thread with ReadPOV, the render thread passes it to Update and projects with it.
+// The view-projection matrix is only rebuilt when the view or the viewport changes.
+class Camera
+{
+public:
+	Camera();
+	virtual ~Camera();
+
+	// pLocalPlayerSig is the match of LOCAL_PLAYER_SIG
+	bool Initialize(char* pLocalPlayerSig);
+
+	// Reads the game memory, returns false when there is no camera (menus, loading screens)
+	bool ReadPOV(POV& newPOV) const;
+
+	// Only uses the given POV, returns false when it can't be projected with
+	bool Update(const POV& newPOV, float fViewportWidth, float fViewportHeight);
+
+	bool IsValid() const { return bIsValid; }
+	const POV& GetPOV() const { return pov; }
+	const FMatrix& GetViewProjectionMatrix() const { return viewProjection; }
+
+	bool WorldToScreen(const FVector& worldPos, FVector2D& screenPos) const;
+
+	// Batched WorldToScreen, 4 positions per iteration. Positions behind the camera or outside of the
+	// frustum get bIsVisible false and an unspecified screen position. Returns the visible count.
+	size_t WorldToScreen(const FVector* pWorldPos, size_t count, FVector2D* pScreenPos, bool* pIsVisible) const;
+private:
+	char* pLocalPlayerStaticPtr;
+	POV pov;
+	float fViewportSize[2];
+	FMatrix viewProjection;
+	bool bIsValid;
+
+	void BuildViewProjectionMatrix();
+};
@@ -3,16 +3,14 @@
 ConfigManager::ConfigManager() : configMutex(), configData()
 {
 	WCHAR tmp[MAX_PATH] = { 0 };
-	if (GetModuleFileNameW(0, tmp, MAX_PATH) == 0)
+	if (GetModuleFileNameW(0, tmp, MAX_PATH) != 0)
 	{
-		wsFilePath = CONFIG_FILE_NAME;
-	}
-	else
-	{
-		wsFilePath = std::wstring(tmp);
-		auto pos = wsFilePath.find_last_of('\\');
-		wsFilePath = wsFilePath.substr(0, pos + 1) + CONFIG_FILE_NAME;
+		wsDirectory = std::wstring(tmp);
+		auto pos = wsDirectory.find_last_of('\\');
+		wsDirectory = wsDirectory.substr(0, pos + 1);
 	}
+
+	wsFilePath = wsDirectory + CONFIG_FILE_NAME;
 }
 
 
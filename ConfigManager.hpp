@@ -8,6 +8,9 @@
 #include <windows.h>
 
 #define CONFIG_FILE_NAME L"lop_bars.cfg"
+#define SIGNATURE_CACHE_FILE_NAME L"lop_bars.cache"
+#define TRACE_FILE_NAME L"lop_bars_trace.json"
+#define LOG_FILE_NAME L"lop_bars.log"
 
 class ConfigManager
 {
@@ -55,7 +58,11 @@ public:
 
 	std::optional<std::string> Get(const std::string& key, bool loadAndGet = false);
 	void Set(const std::string& key, const std::string& value, bool setAndSave = false);
+
+	// Path of a file stored next to the config file
+	std::wstring GetFilePath(const std::wstring& fileName) const { return wsDirectory + fileName; }
 private:
+	std::wstring wsDirectory;
 	std::wstring wsFilePath;
 	std::recursive_mutex configMutex;
 	std::fstream configFile;
@@ -4,7 +4,7 @@
 #include <future>
 #include <unordered_set>
 #include "utility/Log.hpp"
-#include "utility/Thread.hpp"
+#include "utility/HookTransaction.hpp"
 #include "utility/Module.hpp"
 #include "utility/Memory.hpp"
 #include "WindowFilter.hpp"
@@ -16,6 +16,16 @@ D3D12Hook::~D3D12Hook()
 }
 
 bool D3D12Hook::Hook()
+{
+	HookTransaction transaction;
+
+	if (!Hook(transaction))
+		return false;
+
+	return transaction.Commit() && bIsHooked;
+}
+
+bool D3D12Hook::Hook(HookTransaction& transaction)
 {
 	LOG_INFO("Hooking D3D12...");
 
@@ -314,30 +324,32 @@ bool D3D12Hook::Hook()
 		}
 	}
 
-	utility::ThreadSuspender threadSuspender;
+	LOG_INFO("Queuing hooks...");
 
-	try
-	{
-		LOG_INFO("Initializing hooks...");
+	// Installed with the other hooks of the transaction
+	transaction.Add([this]()
+		{
+			pPresentPtrHook.reset();
+			pSwapChainVTableHook.reset();
+			return true;
+		});
 
-		pPresentPtrHook.reset();
-		pSwapChainVTableHook.reset();
+	bIsPhase1 = true;
 
-		bIsPhase1 = true;
+	auto& fnPresent = (*(void***)pSwapChain)[8]; // Present
+	auto& fnResizeBuffers = (*(void***)pSwapChain)[13]; // ResizeBuffers
+	auto& fnResizeTargets = (*(void***)pSwapChain)[14]; // ResizeTarget
+	transaction.AddPointerHook(pPresentPtrHook, &fnPresent, (void*)&D3D12Hook::Present);
 
-		auto& fnPresent = (*(void***)pSwapChain)[8]; // Present
-		auto& fnResizeBuffers = (*(void***)pSwapChain)[13]; // ResizeBuffers
-		auto& fnResizeTargets = (*(void***)pSwapChain)[14]; // ResizeTarget
-		pPresentPtrHook = std::make_unique<PointerHook>(&fnPresent, (void*)&D3D12Hook::Present);
-		bIsHooked = true;
-	}
-	catch (const std::exception& e)
-	{
-		LOG_ERROR("Failed to initialize hooks: " << e.what());
-		bIsHooked = false;
-	}
+	transaction.Add([this]()
+		{
+			bIsHooked = pPresentPtrHook != nullptr;
+
+			if (!bIsHooked)
+				LOG_ERROR("Failed to initialize hooks");
 
-	threadSuspender.ResumeAll();
+			return bIsHooked;
+		});
 
 	pDevice->Release();
 	pCommandQueue->Release();
@@ -355,7 +367,7 @@ bool D3D12Hook::Hook()
 		::UnregisterClass(wc.lpszClassName, wc.hInstance);
 	}
 
-	return bIsHooked;
+	return true;
 }
 
 bool D3D12Hook::Unhook()
@@ -500,6 +512,8 @@ HRESULT WINAPI D3D12Hook::Present(IDXGISwapChain3* pSwapChain, UINT dwSyncInterv
 
 	if (!hkD3D12.bIgnoreNextPresent)
 	{
+		utility::ScopedTimer presentTimer(hkD3D12.presentZone);
+
 		result = fnPresent(pSwapChain, dwSyncInterval, dwFlags);
 
 		if (result != S_OK)
@@ -13,6 +13,9 @@
 #include <dxgi1_4.h>
 #include "utility/PointerHook.hpp"
 #include "utility/VtableHook.hpp"
+#include "utility/Profiler.hpp"
+
+class HookTransaction;
 
 class D3D12Hook
 {
@@ -33,6 +36,8 @@ public:
 	D3D12Hook& operator=(const D3D12Hook&& other) = delete;
 
 	bool Hook();
+	// Queues the hooks into transaction, they are installed by its Commit
+	bool Hook(HookTransaction& transaction);
 	bool Unhook();
 	bool IsHooked() { return bIsHooked; }
 	
@@ -72,6 +77,8 @@ private:
 	bool bIgnoreNextPresent = false;
 	bool bIsProtonSwapChain = false;
 
+	size_t presentZone = utility::Profiler::GetInstance().AddZone("Present");
+
 	std::unique_ptr<PointerHook> pPresentPtrHook;
 	std::unique_ptr<VtableHook> pSwapChainVTableHook;
 
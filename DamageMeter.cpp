@@ -0,0 +1,118 @@
+#include "DamageMeter.hpp"
+#include <algorithm>
+
+DamageMeter::DamageMeter() : hits(), head(0), rolling(), burst(), pTarget(nullptr), iLastHealth(-1), fightStart(), iFightDamage(0)
+{
+}
+
+DamageMeter::~DamageMeter()
+{
+}
+
+void DamageMeter::Update(const void* pNewTarget, int iHealth, time_point now)
+{
+	if (pNewTarget != pTarget)
+	{
+		Reset();
+		pTarget = pNewTarget;
+		iLastHealth = iHealth;
+		return;
+	}
+
+	// Heals and respawns only move the reference
+	if (iHealth < iLastHealth)
+		Add(iLastHealth - iHealth, now);
+
+	iLastHealth = iHealth;
+}
+
+void DamageMeter::Reset()
+{
+	head = 0;
+	rolling = WINDOW{ 0, 0 };
+	burst = WINDOW{ 0, 0 };
+	pTarget = nullptr;
+	iLastHealth = -1;
+	fightStart = time_point();
+	iFightDamage = 0;
+}
+
+float DamageMeter::GetRollingDps(time_point now)
+{
+	return GetDps(rolling, ROLLING_WINDOW, now);
+}
+
+float DamageMeter::GetBurstDps(time_point now)
+{
+	return GetDps(burst, BURST_WINDOW, now);
+}
+
+float DamageMeter::GetTimeToKill(time_point now)
+{
+	float fDps = GetRollingDps(now);
+	if (fDps <= 0.0f || iLastHealth <= 0)
+		return -1.0f;
+
+	return iLastHealth / fDps;
+}
+
+void DamageMeter::Add(int iDamage, time_point now)
+{
+	// First hit after a pause, the previous hits already left both windows
+	if (head == 0 || now - hits[(head - 1) & (LOG_SIZE - 1)].time > FIGHT_TIMEOUT)
+	{
+		fightStart = now;
+		iFightDamage = 0;
+	}
+
+	HIT& last = hits[(head - 1) & (LOG_SIZE - 1)];
+
+	// Too recent to have left a window, add to it
+	if (head > 0 && now - last.time < MERGE_INTERVAL)
+	{
+		last.iDamage += iDamage;
+		rolling.iDamage += iDamage;
+		burst.iDamage += iDamage;
+		iFightDamage += iDamage;
+		return;
+	}
+
+	// The ring is full, the oldest hit is about to be overwritten so it leaves the windows now
+	for (WINDOW* pWindow : { &rolling, &burst })
+	{
+		if (head - pWindow->tail == LOG_SIZE)
+		{
+			pWindow->iDamage -= hits[pWindow->tail & (LOG_SIZE - 1)].iDamage;
+			++pWindow->tail;
+		}
+	}
+
+	hits[head & (LOG_SIZE - 1)] = HIT{ now, iDamage };
+	++head;
+
+	rolling.iDamage += iDamage;
+	burst.iDamage += iDamage;
+	iFightDamage += iDamage;
+}
+
+void DamageMeter::Expire(WINDOW& window, std::chrono::steady_clock::duration length, time_point now)
+{
+	while (window.tail < head && now - hits[window.tail & (LOG_SIZE - 1)].time > length)
+	{
+		window.iDamage -= hits[window.tail & (LOG_SIZE - 1)].iDamage;
+		++window.tail;
+	}
+}
+
+float DamageMeter::GetDps(WINDOW& window, std::chrono::steady_clock::duration length, time_point now)
+{
+	Expire(window, length, now);
+
+	if (window.iDamage <= 0)
+		return 0.0f;
+
+	// Early in a fight only the time since its first hit counts, at least a second so one hit is not a spike
+	std::chrono::steady_clock::duration elapsed = std::clamp<std::chrono::steady_clock::duration>(now - fightStart, std::chrono::seconds(1), length);
+
+	return window.iDamage / std::chrono::duration<float>(elapsed).count();
+}
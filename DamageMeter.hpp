@@ -0,0 +1,66 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// Damage taken by the target, recorded from the drops of its current health between two samples.
+// Hits are kept in a fixed ring, the rolling and burst windows keep their own running sum so a sample
+// only adds the new hit and drops the ones that left the windows. Nothing is allocated or locked, it is
+// owned by the thread calling Update.
+class DamageMeter
+{
+public:
+	static constexpr size_t LOG_SIZE = 512; // Power of two
+	static constexpr auto MERGE_INTERVAL = std::chrono::milliseconds(50); // Hits closer than this share an entry, so the ring covers the rolling window at any sampling rate
+	static constexpr auto ROLLING_WINDOW = std::chrono::seconds(10);
+	static constexpr auto BURST_WINDOW = std::chrono::seconds(2);
+	static constexpr auto FIGHT_TIMEOUT = std::chrono::seconds(10); // Without hits the next one starts a new fight
+
+	typedef std::chrono::steady_clock::time_point time_point;
+
+	DamageMeter();
+	virtual ~DamageMeter();
+
+	// Records the health drop since the previous call, a new target resets the log
+	void Update(const void* pTarget, int iHealth, time_point now);
+
+	void Reset();
+
+	// Damage per second over the last ROLLING_WINDOW or BURST_WINDOW, shorter at the start of a fight
+	float GetRollingDps(time_point now);
+	float GetBurstDps(time_point now);
+
+	// Seconds until the target dies at the rolling DPS, negative when it is not taking damage
+	float GetTimeToKill(time_point now);
+
+	int64_t GetFightDamage() const { return iFightDamage; }
+private:
+	struct HIT
+	{
+		time_point time;
+		int iDamage;
+	};
+
+	// Running sum of the hits from tail to the newest one
+	struct WINDOW
+	{
+		uint64_t tail;
+		int64_t iDamage;
+	};
+
+	std::array<HIT, LOG_SIZE> hits;
+	uint64_t head; // Position of the next hit, positions only grow
+	WINDOW rolling;
+	WINDOW burst;
+
+	const void* pTarget;
+	int iLastHealth;
+	time_point fightStart;
+	int64_t iFightDamage;
+
+	void Add(int iDamage, time_point now);
+	void Expire(WINDOW& window, std::chrono::steady_clock::duration length, time_point now);
+	float GetDps(WINDOW& window, std::chrono::steady_clock::duration length, time_point now);
+};
@@ -1,19 +1,33 @@
 #include "EntityBars.hpp"
 #include "utility/Module.hpp"
 #include "utility/Memory.hpp"
+#include "utility/SignatureSet.hpp"
+#include "utility/RegionMap.hpp"
+#include "utility/PtrChain.hpp"
+#include "utility/String.hpp"
 #include "utility/Log.hpp"
+#include "utility/HookTransaction.hpp"
 #include "ConfigManager.hpp"
 #include <format>
 #include <limits>
+#include <algorithm>
+#include <functional>
 
-EntityBars::EntityBars() : context(), bIsInitialized(false), pLockOnSystemStaticPtr(nullptr), target(), fnGetMaxDurability(nullptr)
+#pragma comment(lib, "Synchronization.lib")
+
+EntityBars::EntityBars() : context(), bIsInitialized(false), pLockOnSystemStaticPtr(nullptr), target(), buffIndex(), maxStatMulIndex(), fnGetMaxDurability(nullptr), pBuildupHook(nullptr), nearby(), bShowNearby(true), camera(), bShowNameplates(false), damageMeter(), bShowDamageMeter(true),
+	postureTrend(POSTURE_TREND_TIME_CONSTANT), staggerTrend(STAGGER_TREND_TIME_CONSTANT), pTrendTarget(nullptr), iLastPosture(0), lastTrendSample(), bShowRegen(true),
+	snapshots(), lastSnapshot(), basicStatTexts(), staggerDurationText(), buildupTexts(), debuffTexts(), durabilityTexts(), nearbyTexts(), dpsText(), timeToKillText(), fightDamageText(), postureRegenText(), staggerBreakText(),
+	basicStatFills(), staggerDurationFill(), buildupFills(), durabilityFills(), nearbyFills(), pNearbyFillBase(), iNearbyFillCount(0), frameTime(), animationEndTime(), samplingInterval(), pThreadUpdateEntity(nullptr)
 {
 	context.bShowWindow = true;
 }
 
 EntityBars::~EntityBars()
 {
-
+	// Stop sampling before the members it uses are destroyed
+	pThreadUpdateEntity.reset();
+	pBuildupHook.reset();
 }
 
 bool EntityBars::OnInitialize()
@@ -36,7 +50,36 @@ bool EntityBars::OnInitialize()
 		return false;
 	}
 
-	char* ptr = utility::PatternScan(GET_LOCKONSYSTEM_FN_SIG, sizeof(GET_LOCKONSYSTEM_FN_SIG), hExec, sizeExec.value_or(0));
+	utility::SignatureSet signatures;
+	const size_t iLockOnSystemSig = signatures.Add(GET_LOCKONSYSTEM_FN_SIG, sizeof(GET_LOCKONSYSTEM_FN_SIG), ".text");
+	const size_t iMaxDurabilitySig = signatures.Add(GET_MAX_DURABILITY_FN_SIG, sizeof(GET_MAX_DURABILITY_FN_SIG), ".text");
+	const size_t iCalcDirectBuildupSig = signatures.Add(CALC_DIRECT_BUILDUP_FN_SIG, sizeof(CALC_DIRECT_BUILDUP_FN_SIG), ".text");
+	const size_t iLocalPlayerSig = signatures.Add(LOCAL_PLAYER_SIG, sizeof(LOCAL_PLAYER_SIG), ".text");
+
+	const std::wstring wsCachePath = ConfigManager::GetInstance().GetFilePath(SIGNATURE_CACHE_FILE_NAME);
+
+	if (signatures.LoadCache(hExec, wsCachePath))
+	{
+		LOG_INFO("Signatures restored from cache");
+	}
+	else
+	{
+		// Code signatures only need the .text section, fall back to the whole image
+		// in case a protected build moves the code into other sections
+		signatures.Resolve(hExec);
+
+		if (signatures.Get(iLockOnSystemSig) == nullptr || signatures.Get(iMaxDurabilitySig) == nullptr)
+		{
+			LOG_WARNING("Signatures not found in their sections, scanning the whole executable...");
+			signatures.Resolve(hExec, sizeExec.value_or(0));
+		}
+
+		// The optional signatures are cached as missing too, they are not searched again for this build
+		if (signatures.Get(iLockOnSystemSig) != nullptr && signatures.Get(iMaxDurabilitySig) != nullptr)
+			signatures.SaveCache(hExec, wsCachePath);
+	}
+
+	char* ptr = signatures.Get(iLockOnSystemSig);
 	if (ptr == nullptr)
 	{
 		LOG_ERROR("Failed to find GetLockOnSystem function signature");
@@ -67,7 +110,7 @@ bool EntityBars::OnInitialize()
 		return false;
 	}
 
-	ptr = utility::PatternScan(GET_MAX_DURABILITY_FN_SIG, sizeof(GET_MAX_DURABILITY_FN_SIG), hExec, sizeExec.value_or(0));
+	ptr = signatures.Get(iMaxDurabilitySig);
 	if (ptr == nullptr)
 	{
 		LOG_ERROR("Failed to find GetMaxDurability function signature");
@@ -76,9 +119,27 @@ bool EntityBars::OnInitialize()
 
 	fnGetMaxDurability = (GetMaxDurability)ptr;
 
+	// Optional, without it the buildup is only polled at the sampling rate.
+	// Opt-in until the signature is checked against the disassembly, a wrong match would run the detour on another function.
+	if (ConfigManager::GetInstance().Get<int>("HookBuildup").value_or(0))
+		InitializeBuildupHook(signatures.Get(iCalcDirectBuildupSig));
+
+	bShowNearby = ConfigManager::GetInstance().Get<int>("ShowNearbyEntities").value_or(1);
+
+	bShowDamageMeter = ConfigManager::GetInstance().Get<int>("ShowDamageMeter").value_or(1);
+	bShowRegen = ConfigManager::GetInstance().Get<int>("ShowRegenEstimates").value_or(1);
+
+	// Floating bars over the shown entities, the POV offsets are the ones of 1.3.0
+	if (ConfigManager::GetInstance().Get<int>("ShowNameplates").value_or(0))
+		bShowNameplates = camera.Initialize(signatures.Get(iLocalPlayerSig));
+
+	int iSamplingRate = ConfigManager::GetInstance().Get<int>("SamplingRate").value_or(DEFAULT_SAMPLING_RATE);
+	iSamplingRate = std::clamp(iSamplingRate, 1, MAX_SAMPLING_RATE);
+	samplingInterval = std::chrono::microseconds(1000000 / iSamplingRate);
+
 	bIsInitialized = true;
 
-	//pThreadUpdateEntity = std::make_unique<std::jthread>(std::bind_front(&EntityBars::UpdateEntityData, this));
+	pThreadUpdateEntity = std::make_unique<std::jthread>(std::bind_front(&EntityBars::UpdateEntityData, this));
 
 	LOG_INFO("EntityBars initialized!");
 
@@ -92,374 +153,610 @@ void EntityBars::OnReset()
 
 	std::scoped_lock _{ context.mutex };
 	context.bEnableDrag = false;
+
+	// Device resets may unload the driver modules, rebuild the region map lazily
+	utility::RegionMap::GetInstance().Invalidate();
 }
 
-void EntityBars::ShowBasicStats(int iValues[], float fValues[], const ImVec2& progressBarSize)
+// Filled by the CalcDirectBuildupHitByHit hook on the game threads, drained by the sampler thread
+static utility::MpscQueue<BUILDUP_EVENT, BUILDUP_EVENT_QUEUE_SIZE> gBuildupEvents;
+static std::atomic<uint32_t> gBuildupPending = 0; // Set with each push, the sampler waits on its address
+static CalcDirectBuildupHitByHit gfnCalcDirectBuildupHitByHit = nullptr;
+
+static void* __fastcall OnCalcDirectBuildupHitByHit(void* pAbnormalComponent, void* pResult, const void* pHitInfo, int iSkill, int iFire, int iElectric, int iAcid)
 {
-	// Read all buff values
-	static int iBuffValues[4]; // Max health, Max stamina, Max toughness, Max Stagger
+	void* pReturn = gfnCalcDirectBuildupHitByHit(pAbnormalComponent, pResult, pHitInfo, iSkill, iFire, iElectric, iAcid);
+
+	// Never blocks the game thread, a full queue only delays the bars until the next sample
+	if ((iFire != 0 || iElectric != 0 || iAcid != 0) && gBuildupEvents.TryPush(BUILDUP_EVENT{ (char*)pAbnormalComponent }) &&
+		gBuildupPending.exchange(1, std::memory_order_release) == 0)
+		WakeByAddressSingle(&gBuildupPending);
+
+	return pReturn;
+}
 
-	memset(iBuffValues, 0, sizeof(int) * 4);
+bool EntityBars::InitializeBuildupHook(char* pCalcDirectBuildup)
+{
+	if (pCalcDirectBuildup == nullptr)
+	{
+		LOG_WARNING("Failed to find CalcDirectBuildupHitByHit function signature, buildup will be polled");
+		return false;
+	}
 
-	char* ptr;
-	unsigned char t;
-	for (int i = 0; i < target.buffList.iSize; ++i)
+	pBuildupHook = std::make_unique<FunctionHook>(pCalcDirectBuildup, (void*)&OnCalcDirectBuildupHitByHit);
+	if (!pBuildupHook->IsValid())
 	{
-		ptr = target.buffList.pList + (i * 0x18);
-		t = *(unsigned char*)(ptr + 0x8);
-		switch (t)
-		{
-			case ENTITY_STATS::S_HEALTH_POINT_MAX:
-				iBuffValues[0] = *(int*)(ptr + 0xC);
-				break;
-			case ENTITY_STATS::S_STAMINA_POINT_MAX:
-				iBuffValues[1] = *(int*)(ptr + 0xC);
-				break;
-			case ENTITY_STATS::S_TOUGH_POINT_MAX:
-				iBuffValues[2] = *(int*)(ptr + 0xC);
-				break;
-			case ENTITY_STATS::S_GROGGY_POINT_MAX:
-				iBuffValues[3] = *(int*)(ptr + 0xC);
-				break;
-		}
+		pBuildupHook.reset();
+		return false;
 	}
 
-	static float fMulStatValues[4];
+	// Must be set before the hook can be called
+	gfnCalcDirectBuildupHitByHit = (CalcDirectBuildupHitByHit)pBuildupHook->GetOriginal();
+
+	LOG_INFO("CalcDirectBuildupHitByHit hook created, buildup bars follow the hits");
 
-	memset(fMulStatValues, 0, sizeof(float) * 4);
+	return true;
+}
+
+void EntityBars::OnQueueHooks(HookTransaction& transaction)
+{
+	// Enabled with the D3D12 hooks
+	if (pBuildupHook != nullptr)
+		transaction.AddFunctionHook(*pBuildupHook);
+}
+
+// Reads a TArray and checks that all of its elements are readable, an invalid list is returned empty
+template <size_t... Offsets>
+static LIST_DATA ReadList(char* pBase, size_t elementSize)
+{
+	auto list = utility::PtrChain<Offsets...>::template Read<LIST_DATA>(pBase).value_or(LIST_DATA{ nullptr, -1 });
+
+	if (list.iSize > 0 && !utility::RegionMap::GetInstance().IsReadable(list.pList, list.iSize * elementSize))
+		list = LIST_DATA{ nullptr, -1 };
+
+	return list;
+}
+
+// Reads the buildup of the snapshot again when one of the queued hits landed on the target, returns true when it did.
+// The hook arguments are the buildup damage before the resistances and its caller may not apply it,
+// only the values the game applied are shown.
+bool EntityBars::DrainBuildupEvents(ENTITY_SNAPSHOT& snapshot)
+{
+	bool bIsTargetHit = false;
+	BUILDUP_EVENT event;
+
+	while (gBuildupEvents.TryPop(event))
+		bIsTargetHit |= target.pAbnormalComponent != nullptr && event.pAbnormalComponent == target.pAbnormalComponent;
+
+	if (!bIsTargetHit || !snapshot.bIsValid)
+		return false;
+
+	target.abnormalStatList = ReadList<0x850, 0xD0>(target.pBase, 0x10);
 
-	for (int i = 0; i < target.maxStatMulList.iSize; ++i)
+	memset(snapshot.buildup, 0, sizeof(snapshot.buildup));
+	snapshot.bHasBuildup = target.abnormalStatList.iSize > -1;
+	if (snapshot.bHasBuildup)
+		SampleElementalBuildup(snapshot);
+
+	return true;
+}
+
+void EntityBars::UpdateEntityData(std::stop_token stopToken)
+{
+	WND_CONTEXT tmpContext;
+	auto nextSample = std::chrono::steady_clock::now();
+
+	// Wake the wait below when stopping instead of letting it time out
+	std::stop_callback onStop(stopToken, []()
+	{
+		gBuildupPending.store(1, std::memory_order_release);
+		WakeByAddressSingle(&gBuildupPending);
+	});
+
+	while (!stopToken.stop_requested())
 	{
-		ptr = target.maxStatMulList.pList + (i * 0x18);
-		t = *(unsigned char*)(ptr + 0x8);
-		switch (t)
+		context.GetData(tmpContext);
+
+		// Heap regions cached during the last sample may have been freed since
+		utility::RegionMap::GetInstance().InvalidatePrivate();
+
+		auto& snapshot = snapshots.GetWriteBuffer();
+
+		// The hits queued until now are part of the values read below
+		for (BUILDUP_EVENT event; gBuildupEvents.TryPop(event);) {}
+
+		// Padding included, snapshots are hashed as raw bytes
+		memset(&snapshot, 0, sizeof(ENTITY_SNAPSHOT));
+
+		snapshot.bIsValid = tmpContext.bShowWindow && SampleTarget(snapshot);
+
+		if (tmpContext.bShowWindow && bShowNearby)
+			SampleNearby(snapshot);
+
+		if (tmpContext.bShowWindow && bShowNameplates)
+			snapshot.bHasCamera = camera.ReadPOV(snapshot.pov);
+
+		lastSnapshot = snapshot;
+		snapshots.Publish();
+
+		// Skip the samples that were missed instead of catching up
+		nextSample = std::max(nextSample + samplingInterval, std::chrono::steady_clock::now());
+
+		// Until the next sample, publish the buildup again as soon as the hook reports a hit on the target.
+		// The flag is cleared before draining so a hit pushed meanwhile makes the next wait return at once.
+		for (auto now = std::chrono::steady_clock::now(); !stopToken.stop_requested() && now < nextSample; now = std::chrono::steady_clock::now())
 		{
-			case ENTITY_STATS::S_HEALTH_POINT_MAX:
-				fMulStatValues[0] = *(int*)(ptr + 0xC) / 10000.0f;
-				break;
-			case ENTITY_STATS::S_STAMINA_POINT_MAX:
-				fMulStatValues[1] = *(int*)(ptr + 0xC) / 10000.0f;
-				break;
-			case ENTITY_STATS::S_TOUGH_POINT_MAX:
-				fMulStatValues[2] = *(int*)(ptr + 0xC) / 10000.0f;
-				break;
-			case ENTITY_STATS::S_GROGGY_POINT_MAX:
-				fMulStatValues[3] = *(int*)(ptr + 0xC) / 10000.0f;
-				break;
+			uint32_t uIdle = 0;
+			WaitOnAddress(&gBuildupPending, &uIdle, sizeof(uIdle), (DWORD)std::chrono::ceil<std::chrono::milliseconds>(nextSample - now).count());
+
+			if (gBuildupPending.exchange(0, std::memory_order_acquire) == 0 || !DrainBuildupEvents(lastSnapshot))
+				continue;
+
+			snapshots.GetWriteBuffer() = lastSnapshot;
+			snapshots.Publish();
 		}
 	}
+}
 
-	ImGui::SeparatorText("Stats");
+bool EntityBars::SampleTarget(ENTITY_SNAPSHOT& snapshot)
+{
+	// LockOnSystem -> LockOnSystemData -> locked-on target
+	auto pTarget = utility::PtrChain<0x0, 0x98, 0x200>::Read<char*>(pLockOnSystemStaticPtr);
+	if (!pTarget || *pTarget == nullptr)
+		return false;
+
+	target.pBase = *pTarget;
+
+	// Get only objects that have their instigator reference as themselves
+	if (utility::PtrChain<0xD8>::Read<char*>(target.pBase) != target.pBase)
+		return false;
+
+	target.bFaction = utility::PtrChain<0x760>::Read<unsigned char>(target.pBase).value_or(ENTITY_FACTION::F_NONE);
+
+	// Quick offset fix for 1.2.0
+	//target.pBase -= 0x10;
+
+	// Get entity's StatComponent lists, filter out incomplete StatLists
+	target.statList = ReadList<0x848, 0xE0, 0x28>(target.pBase, 0x30);
+	if (target.statList.iSize < 130)
+		return false;
+
+	target.buffList = ReadList<0x848, 0xE0, 0x38>(target.pBase, 0x18);
+
+	target.maxStatMulList = ReadList<0x848, 0xE0, 0x58>(target.pBase, 0x18);
+
+	// Get entity's AbnormalComponent
+	target.pAbnormalComponent = utility::PtrChain<0x850>::Read<char*>(target.pBase).value_or(nullptr);
+	target.abnormalStatList = ReadList<0x850, 0xD0>(target.pBase, 0x10);
+
+	// Get entity's EquipmentComponent
+	target.weaponList = ReadList<0x858, 0xF8>(target.pBase, 0x40); // 0xF8 for 1.3.0 and 0xF0 for 1.2.0
+
+	// Nameplate position
+	if (utility::RegionMap::GetInstance().IsReadable(target.pBase + 0x149C, sizeof(FVector)))
+		snapshot.headTag = *(FVector*)(target.pBase + 0x149C);
+
+	//FVector entityPos = *(FVector*)(*(uintptr_t*)(target.pBase + 0xF0) + 0x10C);
+
+	SampleBasicStats(snapshot);
+
+	if (bShowDamageMeter)
+		SampleDamage(snapshot);
+
+	if (bShowRegen)
+		SampleRegen(snapshot);
+
+	snapshot.bHasBuildup = target.abnormalStatList.iSize > -1;
+	if (snapshot.bHasBuildup)
+		SampleElementalBuildup(snapshot);
+
+	if (target.weaponList.iSize > 0)
+		SampleWeaponsDurability(snapshot);
+
+	return true;
+}
+
+void EntityBars::SampleBasicStats(ENTITY_SNAPSHOT& snapshot)
+{
+	// Look up the buff values, the indexes are only rebuilt when the target or its lists change
+	buffIndex.Update(target.pBase, target.buffList);
+	maxStatMulIndex.Update(target.pBase, target.maxStatMulList);
+
+	const int iBuffValues[4] = // Max health, Max stamina, Max toughness, Max Stagger
+	{
+		buffIndex.Get(ENTITY_STATS::S_HEALTH_POINT_MAX),
+		buffIndex.Get(ENTITY_STATS::S_STAMINA_POINT_MAX),
+		buffIndex.Get(ENTITY_STATS::S_TOUGH_POINT_MAX),
+		buffIndex.Get(ENTITY_STATS::S_GROGGY_POINT_MAX),
+	};
+
+	const float fMulStatValues[4] =
+	{
+		maxStatMulIndex.Get(ENTITY_STATS::S_HEALTH_POINT_MAX) / 10000.0f,
+		maxStatMulIndex.Get(ENTITY_STATS::S_STAMINA_POINT_MAX) / 10000.0f,
+		maxStatMulIndex.Get(ENTITY_STATS::S_TOUGH_POINT_MAX) / 10000.0f,
+		maxStatMulIndex.Get(ENTITY_STATS::S_GROGGY_POINT_MAX) / 10000.0f,
+	};
 
 	// Health
-	//*(int*)(target.statList.pList + 0xC) = 1;
-	iValues[0] = *(int*)(target.statList.pList + 0xC);
-	iValues[1] = *(int*)(target.statList.pList + 0xD2C) + iBuffValues[0];
+	snapshot.iHealth[0] = *(int*)(target.statList.pList + 0xC);
+	snapshot.iHealth[1] = *(int*)(target.statList.pList + 0xD2C) + iBuffValues[0];
 	if (fMulStatValues[0] > 0.0f)
-		iValues[1] *= fMulStatValues[0];
-	std::string sText = std::format("Health ({}/{})", iValues[0], iValues[1]);
-	ImGui::ProgressBar((float)iValues[0] / (float)iValues[1], progressBarSize, sText.c_str(), ImVec4(0.4f, 0.0f, 0.0f, 1.0f));
+		snapshot.iHealth[1] *= fMulStatValues[0];
 
 	// Stamina
-	iValues[0] = *(int*)(target.statList.pList + 0x3C);
-	iValues[1] = *(int*)(target.statList.pList + 0xD5C) + iBuffValues[1];
+	snapshot.iStamina[0] = *(int*)(target.statList.pList + 0x3C);
+	snapshot.iStamina[1] = *(int*)(target.statList.pList + 0xD5C) + iBuffValues[1];
 	if (fMulStatValues[1] > 0.0f)
-		iValues[1] *= fMulStatValues[1];
-	sText = std::format("Stamina ({}/{})", iValues[0], iValues[1]);
-	ImGui::ProgressBar((float)iValues[0] / (float)iValues[1], progressBarSize, sText.c_str(), ImVec4(0.0f, 0.4f, 0.0f, 1.0f));
+		snapshot.iStamina[1] *= fMulStatValues[1];
 
 	// Tough
-	iValues[0] = *(int*)(target.statList.pList + 0x18C);
-	iValues[1] = *(int*)(target.statList.pList + 0xE1C) + iBuffValues[2];
+	snapshot.iPosture[0] = *(int*)(target.statList.pList + 0x18C);
+	snapshot.iPosture[1] = *(int*)(target.statList.pList + 0xE1C) + iBuffValues[2];
 	if (fMulStatValues[2] > 0.0f)
-		iValues[1] *= fMulStatValues[2];
-	sText = std::format("Posture ({}/{})", iValues[0], iValues[1]);
-	ImGui::ProgressBar((float)iValues[0] / (float)iValues[1], progressBarSize, sText.c_str(), ImVec4(0.5f, 0.0f, 0.5f, 1.0f));
+		snapshot.iPosture[1] *= fMulStatValues[2];
 
 	// Stagger
-	iValues[0] = *(int*)(target.statList.pList + 0x8DC); // Stagger point
-	iValues[1] = *(int*)(target.statList.pList + 0xE7C) + iBuffValues[3]; // Max stagger point
-	fValues[1] = *(float*)(target.pBase + 0xF60); // Stagger max duration
-	if (iValues[0] == 0 && fValues[1] > 1.0f)
-	{
-		fValues[0] = *(float*)(target.pBase + 0xF68); // Stagger retain/duration
-		sText = std::vformat("Stagger {:.2f}s"sv, std::make_format_args(fValues[0]));
-		ImGui::ProgressBar(fValues[0] / fValues[1], progressBarSize, sText.c_str(), ImVec4(0.6f, 0.6f, 0.6f, 1.0f));
-	}
-	else if (iValues[1] > 0)
-	{
-		if (fMulStatValues[3] > 0.0f)
-			iValues[1] *= fMulStatValues[3];
-		sText = std::format("Stagger ({}/{})", iValues[0], iValues[1]);
-		ImGui::ProgressBar((float)iValues[0] / (float)iValues[1], progressBarSize, sText.c_str(), ImVec4(0.6f, 0.6f, 0.6f, 1.0f));
-	}
+	snapshot.iStagger[0] = *(int*)(target.statList.pList + 0x8DC); // Stagger point
+	snapshot.iStagger[1] = *(int*)(target.statList.pList + 0xE7C) + iBuffValues[3]; // Max stagger point
+	snapshot.fStaggerDuration[1] = *(float*)(target.pBase + 0xF60); // Stagger max duration
+	snapshot.bIsStaggered = snapshot.iStagger[0] == 0 && snapshot.fStaggerDuration[1] > 1.0f;
+	if (snapshot.bIsStaggered)
+		snapshot.fStaggerDuration[0] = *(float*)(target.pBase + 0xF68); // Stagger retain/duration
+	else if (snapshot.iStagger[1] > 0 && fMulStatValues[3] > 0.0f)
+		snapshot.iStagger[1] *= fMulStatValues[3];
 }
 
-void EntityBars::ShowElementalBuildup(const ImVec2& progressBarSize)
+void EntityBars::SampleElementalBuildup(ENTITY_SNAPSHOT& snapshot)
 {
 	size_t end = (target.abnormalStatList.iSize * 0x10);
 	uintptr_t itemAddr;
 	unsigned char e;
-	bool bIsDebuffActive;
-
-	memset(E_BAR_LIST, 0, sizeof(E_BAR) * E_TYPE::COUNT);
 
 	for (size_t i = 0; i < end; i += 0x10)
 	{
 		itemAddr = *(uintptr_t*)(target.abnormalStatList.pList + i);
 
-		e = *(char*)(*(uintptr_t*)(itemAddr + 0x8) + 0x84); // Element type
+		e = utility::PtrChain<0x8, 0x84>::Read<unsigned char>((void*)itemAddr).value_or(E_TYPE::UNKNOWN); // Element type
 
 		if (e < E_TYPE::FIRE || e > E_TYPE::COUNT - 1) // Skip unsupported types
 			continue;
 
-		E_BAR_LIST[e].fValues[0] = *(float*)(itemAddr + 0x258); // Current buildup
-		E_BAR_LIST[e].fValues[1] = *(float*)(itemAddr + 0x254); // Max buildup
-		//E_BAR_LIST[e].fValues[1] = (float)*(int*)(target.statList.pList + E_RESIST_OFFSET[e]); // Max buildup
-		//bIsDebuffActive = (E_BAR_LIST[e].fValues[0] == E_BAR_LIST[e].fValues[1]); // Check if debuff is active
-		bIsDebuffActive = (E_BAR_LIST[e].fValues[1] == 0.0f); // Check if debuff is active
+		auto& bar = snapshot.buildup[e];
+		bar.fValues[0] = *(float*)(itemAddr + 0x258); // Current buildup
+		bar.fValues[1] = *(float*)(itemAddr + 0x254); // Max buildup
+		//bar.fValues[1] = (float)*(int*)(target.statList.pList + E_RESIST_OFFSET[e]); // Max buildup
+		//bar.bIsDebuffActive = (bar.fValues[0] == bar.fValues[1]); // Check if debuff is active
+		bar.bIsDebuffActive = (bar.fValues[1] == 0.0f); // Check if debuff is active
 
 		// Get Retain values if debuff is active
-		if (bIsDebuffActive)
+		if (bar.bIsDebuffActive)
 		{
-			E_BAR_LIST[e].fValues[0] = *(int*)(itemAddr + 0x74) / 1000.0f; // Buildup retain in seconds
-			E_BAR_LIST[e].fValues[1] = *(int*)(itemAddr + 0x78) / 1000.0f; // Buildup max retain in seconds
-			if (E_BAR_LIST[e].fValues[0] < 0.0f)
-				E_BAR_LIST[e].fValues[0] = 0.0f;
+			bar.fValues[0] = *(int*)(itemAddr + 0x74) / 1000.0f; // Buildup retain in seconds
+			bar.fValues[1] = *(int*)(itemAddr + 0x78) / 1000.0f; // Buildup max retain in seconds
+			if (bar.fValues[0] < 0.0f)
+				bar.fValues[0] = 0.0f;
 		}
-
-		// Set the progress bar text
-		E_BAR_LIST[e].sBarText = bIsDebuffActive ?
-			std::format("{} {:.2f}s"sv, E_NAME[e], E_BAR_LIST[e].fValues[0]) :
-			std::format("{} ({}/{})"sv, E_NAME[e], (int)E_BAR_LIST[e].fValues[0], (int)E_BAR_LIST[e].fValues[1]);
 	}
 
-	ImGui::SeparatorText("Buildup");
-
 	for (char i = E_TYPE::FIRE; i < E_TYPE::COUNT; ++i)
 	{
-		if (E_BAR_LIST[i].fValues[1] <= 0.0f)
+		if (snapshot.buildup[i].fValues[1] <= 0.0f)
 		{
-			E_BAR_LIST[i].fValues[1] = (float)*(int*)(target.statList.pList + E_RESIST_OFFSET[i]); // Max buildup
-			E_BAR_LIST[i].sBarText = std::format("{} ({}/{})"sv, E_NAME[i], 0.0f, (int)E_BAR_LIST[i].fValues[1]);
+			snapshot.buildup[i].fValues[1] = (float)*(int*)(target.statList.pList + E_RESIST_OFFSET[i]); // Max buildup
+			snapshot.buildup[i].bIsDebuffActive = false;
 		}
-		ImGui::ProgressBar(E_BAR_LIST[i].fValues[0] / E_BAR_LIST[i].fValues[1], progressBarSize, E_BAR_LIST[i].sBarText.c_str(), E_COLOR[i]);
 	}
-
 }
 
-void EntityBars::ShowWeaponsDurability(int iValues[], const ImVec2& progressBarSize)
+void EntityBars::SampleWeaponsDurability(ENTITY_SNAPSHOT& snapshot)
 {
 	char* pWeapon;
-	bool bShowHeader = true;
+	int iDurability;
 
-	for (int i = 0; i < target.weaponList.iSize; ++i)
+	for (int i = 0; i < target.weaponList.iSize && snapshot.iWeaponCount < MAX_WEAPONS; ++i)
 	{
 		pWeapon = (char*)*(uintptr_t*)(target.weaponList.pList + 0x30 + (i * 0x40));
-		iValues[0] = *(int*)(pWeapon + 0x308);
+		iDurability = utility::PtrChain<0x308>::Read<int>(pWeapon).value_or(-1);
 
-		if (iValues[0] < 0)
+		if (iDurability < 0)
 			continue;
 
-		if (bShowHeader)
+		auto& values = snapshot.iDurability[snapshot.iWeaponCount++];
+		values[0] = iDurability;
+		values[1] = fnGetMaxDurability(pWeapon);
+	}
+}
+
+void EntityBars::SampleNearby(ENTITY_SNAPSHOT& snapshot)
+{
+	// LockOnSystem -> LockOnSystemData -> +0x10 -> lock-on candidates TArray (RE/OnLoadTargetLockSystem.txt)
+	auto candidates = ReadList<0x0, 0x98, 0x10, 0x30>(pLockOnSystemStaticPtr, sizeof(char*));
+	if (candidates.iSize <= 0)
+	{
+		nearby.Clear();
+		return;
+	}
+
+	nearby.Update((char* const*)candidates.pList, candidates.iSize);
+	nearby.Refresh();
+
+	for (size_t i = 0; i < nearby.Count() && snapshot.iNearbyCount < MAX_NEARBY; ++i)
+	{
+		// Already shown with all of its bars
+		if (snapshot.bIsValid && nearby.GetBase(i) == target.pBase)
+			continue;
+
+		snapshot.pNearbyBase[snapshot.iNearbyCount] = nearby.GetBase(i);
+		memcpy(snapshot.iNearbyHealth[snapshot.iNearbyCount], nearby.GetHealth(i), sizeof(snapshot.iNearbyHealth[0]));
+		memcpy(snapshot.iNearbyStagger[snapshot.iNearbyCount], nearby.GetStagger(i), sizeof(snapshot.iNearbyStagger[0]));
+		snapshot.nearbyHeadTags[snapshot.iNearbyCount] = nearby.GetHeadTag(i);
+		++snapshot.iNearbyCount;
+	}
+}
+
+void EntityBars::SampleDamage(ENTITY_SNAPSHOT& snapshot)
+{
+	const auto now = std::chrono::steady_clock::now();
+
+	damageMeter.Update(target.pBase, snapshot.iHealth[0], now);
+
+	// Rounded so the snapshot, and the frame, only change when the shown text does
+	snapshot.iDps[0] = (int)std::lround(damageMeter.GetRollingDps(now));
+	snapshot.iDps[1] = (int)std::lround(damageMeter.GetBurstDps(now));
+	snapshot.fTimeToKill = std::round(damageMeter.GetTimeToKill(now) * 10.0f) / 10.0f;
+	snapshot.iFightDamage = damageMeter.GetFightDamage();
+	snapshot.bHasDamage = snapshot.iFightDamage > 0;
+}
+
+void EntityBars::SampleRegen(ENTITY_SNAPSHOT& snapshot)
+{
+	const auto now = std::chrono::steady_clock::now();
+	const float fDeltaTime = std::chrono::duration<float>(now - lastTrendSample).count();
+	lastTrendSample = now;
+
+	// Samples of another target, or from before a gap in the sampling, don't belong to the fits
+	if (target.pBase != pTrendTarget || fDeltaTime > 1.0f)
+	{
+		pTrendTarget = target.pBase;
+		postureTrend.Clear();
+		staggerTrend.Clear();
+	}
+
+	// Recovery is fitted from the last hit on
+	if (snapshot.iPosture[0] < iLastPosture)
+		postureTrend.Clear();
+
+	iLastPosture = snapshot.iPosture[0];
+	postureTrend.Add((float)snapshot.iPosture[0], fDeltaTime);
+
+	// Hits and recovery together lead to the break, nothing to predict while staggered
+	if (snapshot.bIsStaggered)
+		staggerTrend.Clear();
+	else
+		staggerTrend.Add((float)snapshot.iStagger[0], fDeltaTime);
+
+	// Rounded so the snapshot, and the frame, only change when the shown text does
+	float fSlope = postureTrend.GetSlope();
+	if (postureTrend.GetSpan() >= MIN_TREND_SPAN && fSlope > 0.0f && snapshot.iPosture[0] < snapshot.iPosture[1])
+	{
+		snapshot.fPostureRegen = std::round(fSlope);
+		snapshot.fPostureFullIn = std::round((snapshot.iPosture[1] - snapshot.iPosture[0]) / fSlope * 10.0f) / 10.0f;
+	}
+
+	fSlope = staggerTrend.GetSlope();
+	if (staggerTrend.GetSpan() >= MIN_TREND_SPAN && fSlope < 0.0f && snapshot.iStagger[0] > 0)
+		snapshot.fStaggerBreakIn = std::round(snapshot.iStagger[0] / -fSlope * 10.0f) / 10.0f;
+}
+
+float EntityBars::GetFill(BAR_FILL& fill, float fTarget)
+{
+	float fValue = fill.Get(fTarget, frameTime, samplingInterval);
+
+	// Keep drawing new frames until the bar reached its value
+	animationEndTime = std::max(animationEndTime, fill.startTime + samplingInterval);
+
+	return fValue;
+}
+
+void EntityBars::MatchNearbyFills(const ENTITY_SNAPSHOT& snapshot)
+{
+	BAR_FILL fills[MAX_NEARBY][2];
+
+	// An entity keeps its fills when its slot changes, a new one starts at its value
+	for (int i = 0; i < snapshot.iNearbyCount; ++i)
+	{
+		auto it = std::find(pNearbyFillBase, pNearbyFillBase + iNearbyFillCount, snapshot.pNearbyBase[i]);
+		if (it != pNearbyFillBase + iNearbyFillCount)
 		{
-			bShowHeader = false;
-			ImGui::SeparatorText("Weapons");
+			fills[i][0] = nearbyFills[it - pNearbyFillBase][0];
+			fills[i][1] = nearbyFills[it - pNearbyFillBase][1];
+			continue;
 		}
 
-		iValues[1] = fnGetMaxDurability(pWeapon);
-		std::string sText = std::format("Durability ({}/{})", iValues[0], iValues[1]);
-		ImGui::ProgressBar((float)iValues[0] / (float)iValues[1], progressBarSize, sText.c_str(), ImVec4(0.9f, 0.7f, 0.0f, 1.0f));
+		auto& health = snapshot.iNearbyHealth[i];
+		auto& stagger = snapshot.iNearbyStagger[i];
+		fills[i][0].Set((float)health[0] / (float)health[1], frameTime);
+		fills[i][1].Set((float)stagger[0] / (float)stagger[1], frameTime);
 	}
+
+	memcpy(nearbyFills, fills, snapshot.iNearbyCount * sizeof(fills[0]));
+	memcpy(pNearbyFillBase, snapshot.pNearbyBase, snapshot.iNearbyCount * sizeof(pNearbyFillBase[0]));
+	iNearbyFillCount = snapshot.iNearbyCount;
 }
 
-//FMatrix GetViewProjectionMatrix(const POV& viewInfo)
-//{
-//	auto viewport = ImGui::GetMainViewport();
-//
-//	int x = 0;
-//	int y = 0;
-//
-//	int sizeX = viewport->Size.x;
-//	int sizeY = viewport->Size.y;
-//
-//	FIntRect unconstrainedRect = FIntRect(x, y, x + sizeX, y + sizeY);
-//
-//	FVector viewOrigin = viewInfo.location;
-//	FMatrix viewRotationMatrix = FInverseRotationMatrix(viewInfo.rotation) * FMatrix(
-//		FPlane(0, 0, 1, 0),
-//		FPlane(1, 0, 0, 0),
-//		FPlane(0, 1, 0, 0),
-//		FPlane(0, 0, 0, 1)
-//	);
-//
-//	float XAxisMultiplier;
-//	float YAxisMultiplier;
-//	float MatrixHalfFOV;
-//
-//	//if (sizeX > sizeY)
-//	//{
-//	//	XAxisMultiplier = 1.0f;
-//	//	YAxisMultiplier = sizeX / (float)sizeY;
-//	//	const float HalfXFOV = FMath::DegreesToRadians(MAX(0.001f, viewInfo.fov) / 2.f);
-//	//	const float HalfYFOV = std::atan(std::tan(HalfXFOV) / viewInfo.aspectRatio);
-//	//	MatrixHalfFOV = HalfYFOV;
-//	//}
-//	//else
-//	{
-//		XAxisMultiplier = sizeY / (float)sizeX;
-//		YAxisMultiplier = 1.0f;
-//		//MatrixHalfFOV = MAX(0.001f, viewInfo.fov) * (float)PI / 360.0f;
-//		const float HalfXFOV = FMath::DegreesToRadians(MAX(0.001f, viewInfo.fov) / 2.f);
-//		const float HalfYFOV = std::atan(std::tan(HalfXFOV) / viewInfo.aspectRatio);
-//		MatrixHalfFOV = HalfYFOV;
-//	}
-//
-//	FMatrix projectionMatrix = FReversedZPerspectiveMatrix(
-//		MatrixHalfFOV,
-//		MatrixHalfFOV,
-//		XAxisMultiplier,
-//		YAxisMultiplier,
-//		viewInfo.orthoNearClipPlane,
-//		viewInfo.orthoFarClipPlane
-//	);
-//
-//	FMatrix viewProjectionMatrix = FTranslationMatrix(-viewOrigin) * viewRotationMatrix * projectionMatrix;
-//	return viewProjectionMatrix;
-//}
-//
-//bool WorldToScreen(const FVector& worldPos, FVector2D& screenPos)
-//{
-//	char* pLocalPlayer = (char*)*(uintptr_t*)((char*)utility::GetExecutable() + 0x7357830);
-//	char* pPlayerController = (char*)*(uintptr_t*)(pLocalPlayer + 0x30);
-//	char* pCameraManager = (char*)*(uintptr_t*)(pPlayerController + 0x278);
-//	POV pov = *(POV*)(pCameraManager + 0xF00);
-//
-//	FMatrix viewProjectionMatrix = GetViewProjectionMatrix(pov);
-//	FPlane result = viewProjectionMatrix.TransformFVector4(FVector4(worldPos, 1.0f));
-//
-//	if (result.W <= 0.0f)
-//		return false;
-//
-//	const float RHW = 1.0f / result.W;
-//
-//	FPlane PosInScreenSpace = FPlane(result.X * RHW, result.Y * RHW, result.Z * RHW, result.W);
-//
-//	const float NormalizedX = (PosInScreenSpace.X / 2.f) + 0.5f;
-//	const float NormalizedY = 1.f - (PosInScreenSpace.Y / 2.f) - 0.5f;
-//
-//	auto viewport = ImGui::GetMainViewport();
-//
-//	FVector2D RayStartViewRectSpace(
-//		(NormalizedX * viewport->Size.x),
-//		(NormalizedY * viewport->Size.y)
-//	);
-//
-//	screenPos.X = RayStartViewRectSpace.X;
-//	screenPos.Y = RayStartViewRectSpace.Y;
-//
-//	return true;
-//}
-//
-//void EntityBars::ShowTestWindow(const FVector& headTagPos)
-//{
-//	static FVector2D screenPos;
-//	//static FVector2D lastScreenPos;
-//
-//	FVector roundedHeadTagPos;
-//	roundedHeadTagPos.X = FMath::RoundToFloat(headTagPos.X);
-//	roundedHeadTagPos.Y = FMath::RoundToFloat(headTagPos.Y);
-//	roundedHeadTagPos.Z = FMath::RoundToFloat(headTagPos.Z);
-//
-//	if (!WorldToScreen(roundedHeadTagPos, screenPos))
-//		return;
-//
-//	//if (lastScreenPos.Y - screenPos.Y > 20.0f)
-//	//{
-//	//	int i = 234;
-//	//}
-//	//lastScreenPos = screenPos;
-//
-//	ImGuiWindowFlags windowFlags = ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoNav | ImGuiWindowFlags_NoInputs | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoDecoration;
-//
-//	ImVec2 progressBarSize = ImVec2(-1.0f, ImGui::GetFontSize() - 4.0f);
-//
-//	auto& style = ImGui::GetStyle();
-//	style.WindowRounding = 0.0f;
-//	style.FrameRounding = 0.0f;
-//	style.FrameBorderSize = 1.0f;
-//	style.WindowBorderSize = 0.0f;
-//	style.ItemSpacing = ImVec2(4.0f, 1.0f);
-//
-//	ImGui::SetNextWindowBgAlpha(0.0f);
-//	ImGui::SetNextWindowPos(ImVec2(screenPos.X, screenPos.Y - 3.0f), ImGuiCond_Always, ImVec2(0.5f, 0.5f));
-//	ImGui::SetNextWindowSize(ImVec2(106.0f, 0.0f));
-//	if (ImGui::Begin("TestWindow", nullptr, windowFlags))
-//	{
-//		ImGui::ProgressBar(100 / 100, progressBarSize, "", ImVec4(0.5f, 0.0f, 0.5f, 1.0f));
-//		ImGui::ProgressBar(100 / 100, progressBarSize, "", ImVec4(0.6f, 0.6f, 0.6f, 1.0f));
-//	}
-//	ImGui::End();
-//
-//	style.WindowRounding = 4.0f;
-//	style.FrameRounding = 4.0f;
-//	style.WindowBorderSize = 1.0f;
-//	style.ItemSpacing = ImVec2(8.0f, 4.0f);
-//}
+void EntityBars::ShowBasicStats(const ENTITY_SNAPSHOT& snapshot, const ImVec2& progressBarSize)
+{
+	ImGui::SeparatorText("Stats");
 
-void EntityBars::OnDraw()
+	// Health
+	const char* szText = basicStatTexts[0].Format("Health ({}/{})", snapshot.iHealth[0], snapshot.iHealth[1]);
+	ImGui::ProgressBar(GetFill(basicStatFills[0], (float)snapshot.iHealth[0] / (float)snapshot.iHealth[1]), progressBarSize, szText, ImVec4(0.4f, 0.0f, 0.0f, 1.0f));
+
+	// Stamina
+	szText = basicStatTexts[1].Format("Stamina ({}/{})", snapshot.iStamina[0], snapshot.iStamina[1]);
+	ImGui::ProgressBar(GetFill(basicStatFills[1], (float)snapshot.iStamina[0] / (float)snapshot.iStamina[1]), progressBarSize, szText, ImVec4(0.0f, 0.4f, 0.0f, 1.0f));
+
+	// Tough
+	szText = basicStatTexts[2].Format("Posture ({}/{})", snapshot.iPosture[0], snapshot.iPosture[1]);
+	ImGui::ProgressBar(GetFill(basicStatFills[2], (float)snapshot.iPosture[0] / (float)snapshot.iPosture[1]), progressBarSize, szText, ImVec4(0.5f, 0.0f, 0.5f, 1.0f));
+
+	if (snapshot.fPostureRegen > 0.0f)
+		ImGui::TextUnformatted(postureRegenText.Format("+{:.0f}/s, full in {:.1f}s", snapshot.fPostureRegen, snapshot.fPostureFullIn));
+
+	// Stagger
+	if (snapshot.bIsStaggered)
+	{
+		szText = staggerDurationText.Format("Stagger {:.2f}s", snapshot.fStaggerDuration[0]);
+		ImGui::ProgressBar(GetFill(staggerDurationFill, snapshot.fStaggerDuration[0] / snapshot.fStaggerDuration[1]), progressBarSize, szText, ImVec4(0.6f, 0.6f, 0.6f, 1.0f));
+	}
+	else if (snapshot.iStagger[1] > 0)
+	{
+		szText = basicStatTexts[3].Format("Stagger ({}/{})", snapshot.iStagger[0], snapshot.iStagger[1]);
+		ImGui::ProgressBar(GetFill(basicStatFills[3], (float)snapshot.iStagger[0] / (float)snapshot.iStagger[1]), progressBarSize, szText, ImVec4(0.6f, 0.6f, 0.6f, 1.0f));
+
+		if (snapshot.fStaggerBreakIn > 0.0f)
+			ImGui::TextUnformatted(staggerBreakText.Format("Break in {:.1f}s", snapshot.fStaggerBreakIn));
+	}
+}
+
+void EntityBars::ShowElementalBuildup(const ENTITY_SNAPSHOT& snapshot, const ImVec2& progressBarSize)
 {
-	if (!bIsInitialized)
-		return;
+	ImGui::SeparatorText("Buildup");
 
-	static WND_CONTEXT tmpContext;
-	context.GetData(tmpContext);
+	const char* szText;
+	for (char i = E_TYPE::FIRE; i < E_TYPE::COUNT; ++i)
+	{
+		auto& bar = snapshot.buildup[i];
 
-	auto pLockOnSystem = (char*)*(uintptr_t*)pLockOnSystemStaticPtr;
+		// Set the progress bar text
+		szText = bar.bIsDebuffActive ?
+			debuffTexts[i].Format("{} {:.2f}s", E_NAME[i], bar.fValues[0]) :
+			buildupTexts[i].Format("{} ({}/{})", E_NAME[i], (int)bar.fValues[0], (int)bar.fValues[1]);
 
-	if (!tmpContext.bShowWindow || pLockOnSystem == nullptr)
-		return;
+		ImGui::ProgressBar(GetFill(buildupFills[i], bar.fValues[0] / bar.fValues[1]), progressBarSize, szText, E_COLOR[i]);
+	}
+}
 
-	auto pLockOnSystemData = (char*)*(uintptr_t*)(pLockOnSystem + 0x98);
-	if (pLockOnSystemData == nullptr)
-		return;
+void EntityBars::ShowWeaponsDurability(const ENTITY_SNAPSHOT& snapshot, const ImVec2& progressBarSize)
+{
+	ImGui::SeparatorText("Weapons");
 
-	target.pBase = (char*)*(uintptr_t*)(pLockOnSystemData + 0x200);
-	if (target.pBase == nullptr)
-		return;
+	const char* szText;
+	for (int i = 0; i < snapshot.iWeaponCount; ++i)
+	{
+		szText = durabilityTexts[i].Format("Durability ({}/{})", snapshot.iDurability[i][0], snapshot.iDurability[i][1]);
+		ImGui::ProgressBar(GetFill(durabilityFills[i], (float)snapshot.iDurability[i][0] / (float)snapshot.iDurability[i][1]), progressBarSize, szText, ImVec4(0.9f, 0.7f, 0.0f, 1.0f));
+	}
+}
 
-	// Get only objects that have their instigator reference as themselves
-	if ((void*)*(uintptr_t*)(target.pBase + 0xD8) != target.pBase)
+void EntityBars::ShowDamageMeter(const ENTITY_SNAPSHOT& snapshot)
+{
+	ImGui::SeparatorText("Damage");
+
+	ImGui::TextUnformatted(dpsText.Format("DPS {} (Burst {})", snapshot.iDps[0], snapshot.iDps[1]));
+
+	if (snapshot.fTimeToKill >= 0.0f)
+		ImGui::TextUnformatted(timeToKillText.Format("Kill in {:.1f}s, Total {}", snapshot.fTimeToKill, snapshot.iFightDamage));
+	else
+		ImGui::TextUnformatted(fightDamageText.Format("Total {}", snapshot.iFightDamage));
+}
+
+void EntityBars::ShowNearbyEntities(const ENTITY_SNAPSHOT& snapshot, const ImVec2& progressBarSize)
+{
+	ImGui::SeparatorText("Nearby");
+
+	const ImVec2 staggerBarSize = ImVec2(progressBarSize.x, 4.0f);
+
+	const char* szText;
+	for (int i = 0; i < snapshot.iNearbyCount; ++i)
+	{
+		auto& health = snapshot.iNearbyHealth[i];
+		auto& stagger = snapshot.iNearbyStagger[i];
+
+		szText = nearbyTexts[i].Format("{}/{}", health[0], health[1]);
+		ImGui::ProgressBar(GetFill(nearbyFills[i][0], (float)health[0] / (float)health[1]), progressBarSize, szText, ImVec4(0.4f, 0.0f, 0.0f, 1.0f));
+
+		if (stagger[1] > 0)
+			ImGui::ProgressBar(GetFill(nearbyFills[i][1], (float)stagger[0] / (float)stagger[1]), staggerBarSize, "", ImVec4(0.6f, 0.6f, 0.6f, 1.0f));
+	}
+}
+
+void EntityBars::ShowNameplates(const ENTITY_SNAPSHOT& snapshot)
+{
+	static const ImVec2 plateSize = ImVec2(100.0f, 6.0f);
+
+	FVector headTags[MAX_NEARBY + 1];
+	FVector2D screenPos[MAX_NEARBY + 1];
+	bool bIsVisible[MAX_NEARBY + 1];
+	int count = 0;
+
+	// The locked-on target first, then the nearby ones in the same order as their fills
+	if (snapshot.bIsValid)
+		headTags[count++] = snapshot.headTag;
+
+	for (int i = 0; i < snapshot.iNearbyCount; ++i)
+		headTags[count++] = snapshot.nearbyHeadTags[i];
+
+	// Everything is projected at once with the matrix cached for this frame
+	if (camera.WorldToScreen(headTags, count, screenPos, bIsVisible) == 0)
 		return;
 
-	target.bFaction = *(target.pBase + 0x760);
+	auto pDrawList = ImGui::GetBackgroundDrawList();
+	const ImVec2 viewportPos = ImGui::GetMainViewport()->Pos;
+	const ImU32 backgroundColor = IM_COL32(0, 0, 0, 128);
+	const ImU32 healthColor = ImGui::GetColorU32(ImVec4(0.4f, 0.0f, 0.0f, 1.0f));
+	const ImU32 staggerColor = ImGui::GetColorU32(ImVec4(0.6f, 0.6f, 0.6f, 1.0f));
 
-	// Quick offset fix for 1.2.0
-	//target.pBase -= 0x10;
+	for (int i = 0; i < count; ++i)
+	{
+		if (!bIsVisible[i] || headTags[i].IsZero())
+			continue;
 
-	// Get entity's StatComponent
-	uintptr_t ptr = *(uintptr_t*)(target.pBase + 0x848);
+		const bool bIsTarget = snapshot.bIsValid && i == 0;
+		const int n = snapshot.bIsValid ? i - 1 : i;
 
-	// Filter out incomplete StatLists
-	target.statList = *(LIST_DATA*)(*(uintptr_t*)(ptr + 0xE0) + 0x28);
-	if (target.statList.iSize < 130)
+		float fHealth, fStagger;
+		if (bIsTarget)
+		{
+			fHealth = basicStatFills[0].GetAt(frameTime, samplingInterval);
+			fStagger = snapshot.bIsStaggered ? 0.0f : basicStatFills[3].GetAt(frameTime, samplingInterval);
+		}
+		else
+		{
+			fHealth = nearbyFills[n][0].GetAt(frameTime, samplingInterval);
+			fStagger = snapshot.iNearbyStagger[n][1] > 0 ? nearbyFills[n][1].GetAt(frameTime, samplingInterval) : 0.0f;
+		}
+
+		const ImVec2 min = ImVec2(viewportPos.x + screenPos[i].X - plateSize.x * 0.5f, viewportPos.y + screenPos[i].Y - plateSize.y * 2.0f);
+		const ImVec2 max = ImVec2(min.x + plateSize.x, min.y + plateSize.y);
+
+		pDrawList->AddRectFilled(min, ImVec2(max.x, max.y + plateSize.y * 0.5f), backgroundColor);
+		pDrawList->AddRectFilled(min, ImVec2(min.x + plateSize.x * std::clamp(fHealth, 0.0f, 1.0f), max.y), healthColor);
+
+		if (fStagger > 0.0f)
+			pDrawList->AddRectFilled(ImVec2(min.x, max.y), ImVec2(min.x + plateSize.x * std::clamp(fStagger, 0.0f, 1.0f), max.y + plateSize.y * 0.5f), staggerColor);
+	}
+}
+
+void EntityBars::OnDraw()
+{
+	if (!bIsInitialized)
 		return;
 
-	target.buffList = *(LIST_DATA*)(*(uintptr_t*)(ptr + 0xE0) + 0x38);
+	static WND_CONTEXT tmpContext;
+	context.GetData(tmpContext);
 
-	target.maxStatMulList = *(LIST_DATA*)(*(uintptr_t*)(ptr + 0xE0) + 0x58);
+	// Only the latest sample is rendered, no game memory is read on the render thread
+	auto& snapshot = snapshots.GetReadBuffer();
 
-	// Get entity's AbnormalComponent
-	ptr = *(uintptr_t*)(target.pBase + 0x850);
-	target.abnormalStatList = *(LIST_DATA*)(ptr + 0xD0);
+	if (!tmpContext.bShowWindow || (!snapshot.bIsValid && snapshot.iNearbyCount == 0))
+		return;
 
-	// Get entity's EquipmentComponent
-	ptr = *(uintptr_t*)(target.pBase + 0x858);
-	target.weaponList = *(LIST_DATA*)(ptr + 0xF8); // 0xF8 for 1.3.0 and 0xF0 for 1.2.0
+	frameTime = std::chrono::steady_clock::now();
 
-	//FVector headTag = *(FVector*)(target.pBase + 0x149C);
-	//FVector entityPos = *(FVector*)(*(uintptr_t*)(target.pBase + 0xF0) + 0x10C);
-	//ShowTestWindow(headTag);
+	// Both the nearby bars and the nameplates use the fills in snapshot slot order
+	MatchNearbyFills(snapshot);
 
 	ImGuiWindowFlags windowFlags = ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoNav;
 
@@ -484,24 +781,56 @@ void EntityBars::OnDraw()
 	}
 
 	static ImVec2 progressBarSize = ImVec2(-1.0f, ImGui::GetFontSize() + 7.0f);
+	static ImVec2 nearbyBarSize = ImVec2(-1.0f, ImGui::GetFontSize());
 
 	ImGui::SetNextWindowSize(ImVec2(220.0f, 0.0f));
 	ImGui::SetNextWindowBgAlpha(0.5f);
 
 	if (ImGui::Begin("Entity Bars", nullptr, windowFlags))
 	{
-		static int iValues[2];
-		static float fValues[2];
+		if (snapshot.bIsValid)
+		{
+			ShowBasicStats(snapshot, progressBarSize);
+
+			if (snapshot.bHasBuildup)
+				ShowElementalBuildup(snapshot, progressBarSize);
 
-		ShowBasicStats(iValues, fValues, progressBarSize);
+			if (snapshot.iWeaponCount > 0)
+				ShowWeaponsDurability(snapshot, progressBarSize);
 
-		if (target.abnormalStatList.iSize > -1)
-			ShowElementalBuildup(progressBarSize);
+			if (snapshot.bHasDamage)
+				ShowDamageMeter(snapshot);
+		}
 
-		if (target.weaponList.iSize > 0)
-			ShowWeaponsDurability(iValues, progressBarSize);
+		if (snapshot.iNearbyCount > 0)
+			ShowNearbyEntities(snapshot, nearbyBarSize);
 	}
 	ImGui::End();
+
+	if (snapshot.bHasCamera && camera.Update(snapshot.pov, io.DisplaySize.x, io.DisplaySize.y))
+		ShowNameplates(snapshot);
+}
+
+size_t EntityBars::GetContentHash()
+{
+	WND_CONTEXT tmpContext;
+	context.GetData(tmpContext);
+
+	auto& snapshot = snapshots.GetReadBuffer();
+
+	// Dragging needs a new frame for every mouse move, same for bars still moving to their value
+	if (tmpContext.bEnableDrag || std::chrono::steady_clock::now() < animationEndTime)
+		return 0;
+
+	size_t result = utility::hash(&tmpContext, sizeof(WND_CONTEXT));
+	if (tmpContext.bShowWindow)
+		result = utility::hash(&snapshot, sizeof(ENTITY_SNAPSHOT), result);
+
+	// The camera is in the snapshot, only the viewport size can move the plates on its own
+	if (tmpContext.bShowWindow && snapshot.bHasCamera)
+		result = utility::hash(&ImGui::GetIO().DisplaySize, sizeof(ImVec2), result);
+
+	return result;
 }
 
 bool EntityBars::OnMessage(HWND hwnd, UINT iMsg, WPARAM wParam, LPARAM lParam)
@@ -5,14 +5,21 @@
 #include <mutex>
 #include <thread>
 #include <chrono>
+#include <memory>
+#include <algorithm>
+#include <tuple>
+#include <format>
+#include <string_view>
+#include <cmath>
 #include "imgui.h"
 #include "ImGuiWindow.hpp"
 #include "utility/FunctionHook.hpp"
-//#include "Game/Matrix.h"
-//#include "Game/Vector2D.h"
-//#include "Game/Vector.h"
-//#include "Game/Rotator.h"
-//#include "Game/IntRect.h"
+#include "utility/TripleBuffer.hpp"
+#include "utility/MpscQueue.hpp"
+#include "utility/LinearTrend.hpp"
+#include "EntityTable.hpp"
+#include "Camera.hpp"
+#include "DamageMeter.hpp"
 
 using namespace std::string_view_literals;
 
@@ -34,6 +41,65 @@ struct MUTEX_WND_CONTEXT : WND_CONTEXT
 	}
 };
 
+// Fixed buffer for a progress bar label, the label is only formatted again when the values it shows change
+template <typename... Values>
+struct BAR_TEXT
+{
+	char szText[64];
+	std::tuple<Values...> lastValues;
+	bool bIsFormatted;
+
+	inline const char* Format(std::format_string<const Values&...> fmt, const Values&... values)
+	{
+		if (bIsFormatted && lastValues == std::tie(values...))
+			return szText;
+
+		auto result = std::format_to_n(szText, sizeof(szText) - 1, fmt, values...);
+		*result.out = '\0';
+
+		lastValues = std::tie(values...);
+		bIsFormatted = true;
+
+		return szText;
+	}
+};
+
+// Bar fill that moves to a new value over one sampling interval instead of jumping to it
+struct BAR_FILL
+{
+	float fFrom;
+	float fTo;
+	std::chrono::steady_clock::time_point startTime;
+
+	inline float Get(float fTarget, std::chrono::steady_clock::time_point now, std::chrono::microseconds duration)
+	{
+		if (!std::isfinite(fTarget))
+			fTarget = 0.0f;
+
+		if (fTarget != fTo)
+		{
+			fFrom = GetAt(now, duration);
+			fTo = fTarget;
+			startTime = now;
+		}
+
+		return GetAt(now, duration);
+	}
+
+	// Starts at the value without moving to it
+	inline void Set(float fValue, std::chrono::steady_clock::time_point now)
+	{
+		fFrom = fTo = std::isfinite(fValue) ? fValue : 0.0f;
+		startTime = now;
+	}
+
+	inline float GetAt(std::chrono::steady_clock::time_point now, std::chrono::microseconds duration) const
+	{
+		float t = duration.count() > 0 ? std::chrono::duration<float>(now - startTime) / duration : 1.0f;
+		return fFrom + (fTo - fFrom) * std::clamp(t, 0.0f, 1.0f);
+	}
+};
+
 // --------------------------------ELEMENTAL BUILDUP---------------------------------------
 enum E_TYPE : unsigned char
 {
@@ -72,10 +138,8 @@ static const std::string_view E_NAME[] =
 struct E_BAR
 {
 	float fValues[2];
-	std::string sBarText;
+	bool bIsDebuffActive;
 };
-
-static E_BAR E_BAR_LIST[E_TYPE::COUNT] = { 0 };
 // ----------------------------------------------------------------------------------------
 
 enum ENTITY_FACTION : unsigned char
@@ -122,6 +186,56 @@ struct LIST_DATA
 	int iSize;
 };
 
+// Maps ENTITY_STATS ids to the entries of a buff or max stat multiplier list (0x18 bytes each, id at 0x8, value at 0xC).
+// Only rebuilt when the target or the list changes, stat reads are then a single lookup.
+struct STAT_INDEX
+{
+	char* pTarget = nullptr;
+	LIST_DATA list = { nullptr, -1 };
+	int iEntryOffsets[ENTITY_STATS::S_DEFAULT + 1];
+
+	inline void Update(char* pNewTarget, const LIST_DATA& newList)
+	{
+		if (pNewTarget != pTarget || newList.pList != list.pList || newList.iSize != list.iSize)
+			Rebuild(pNewTarget, newList);
+	}
+
+	inline void Rebuild(char* pNewTarget, const LIST_DATA& newList)
+	{
+		pTarget = pNewTarget;
+		list = newList;
+
+		memset(iEntryOffsets, -1, sizeof(iEntryOffsets));
+
+		unsigned char t;
+		for (int i = 0; i < list.iSize; ++i)
+		{
+			t = *(unsigned char*)(list.pList + (i * 0x18) + 0x8);
+			if (t <= ENTITY_STATS::S_DEFAULT)
+				iEntryOffsets[t] = i * 0x18;
+		}
+	}
+
+	// Returns 0 when the list has no entry for the stat
+	inline int Get(ENTITY_STATS stat)
+	{
+		int offset = iEntryOffsets[stat];
+		if (offset < 0)
+			return 0;
+
+		// Entries can be replaced without the list moving, look again if the slot holds another stat now
+		if (*(unsigned char*)(list.pList + offset + 0x8) != stat)
+		{
+			Rebuild(pTarget, list);
+			offset = iEntryOffsets[stat];
+			if (offset < 0)
+				return 0;
+		}
+
+		return *(int*)(list.pList + offset + 0xC);
+	}
+};
+
 struct ENTITY_PTRS
 {
 	unsigned char bFaction;
@@ -129,21 +243,53 @@ struct ENTITY_PTRS
 	LIST_DATA statList;
 	LIST_DATA buffList;
 	LIST_DATA maxStatMulList;
+	char* pAbnormalComponent;
 	LIST_DATA abnormalStatList;
 	LIST_DATA weaponList;
 };
 
-//struct POV
-//{
-//	FVector location;
-//	FRotator rotation;
-//	float fov;
-//	float desiredFOV;
-//	float orthoWidth;
-//	float orthoNearClipPlane;
-//	float orthoFarClipPlane;
-//	float aspectRatio;
-//};
+// Everything OnDraw needs from the target, filled by the sampler thread
+static const int MAX_WEAPONS = 8;
+static const int MAX_NEARBY = 32;
+
+struct ENTITY_SNAPSHOT
+{
+	bool bIsValid;
+	bool bHasBuildup;
+	bool bIsStaggered; // Stagger bar shows the remaining duration instead of the points
+	int iHealth[2]; // Current, Max
+	int iStamina[2];
+	int iPosture[2];
+	int iStagger[2];
+	float fStaggerDuration[2];
+	float fPostureRegen; // Points per second, 0 when not recovering
+	float fPostureFullIn; // Seconds
+	float fStaggerBreakIn; // Seconds, 0 when the stagger points are not going down
+	E_BAR buildup[E_TYPE::COUNT];
+	int iWeaponCount;
+	int iDurability[MAX_WEAPONS][2];
+	FVector headTag;
+	bool bHasCamera; // Set with the POV when the nameplates are shown
+	POV pov;
+	bool bHasDamage; // Damage meter of the target, the values below are set with it
+	int iDps[2]; // Rolling, Burst
+	float fTimeToKill;
+	int64_t iFightDamage;
+	int iNearbyCount; // Hostile entities around, without the locked-on target
+	const void* pNearbyBase[MAX_NEARBY]; // Identifies the entity of a slot, slots change when entities leave
+	int iNearbyHealth[MAX_NEARBY][2];
+	int iNearbyStagger[MAX_NEARBY][2];
+	FVector nearbyHeadTags[MAX_NEARBY];
+};
+
+// Target reads per second, configurable with "SamplingRate"
+static const int DEFAULT_SAMPLING_RATE = 30;
+static const int MAX_SAMPLING_RATE = 1000;
+
+// Posture and stagger trends, a sample this many seconds old weighs 1/e of the newest one
+static const float POSTURE_TREND_TIME_CONSTANT = 1.0f;
+static const float STAGGER_TREND_TIME_CONSTANT = 3.0f;
+static const float MIN_TREND_SPAN = 0.5f; // Seconds of samples before an estimate is shown
 
 static const short GET_LOCKONSYSTEM_FN_SIG[] =
 {
@@ -183,13 +329,44 @@ static const size_t GET_MAX_DURABILITY_OFFSET = 0x0;
 
 typedef int(__stdcall* GetMaxDurability)(void* pWeapon);
 
+// LAbnormalComponent::CalcDirectBuildupHitByHit prologue, saves the parameters and loads the AbnormalStatList size (+0xD8).
+// Not checked against a disassembly yet, the hook is only installed with "HookBuildup"
+static const short CALC_DIRECT_BUILDUP_FN_SIG[] =
+{
+	0x48, 0x89, 0x5C, 0x24, -1,
+	0x48, 0x89, 0x6C, 0x24, -1,
+	0x48, 0x89, 0x74, 0x24, -1,
+	0x57,
+	0x41, 0x56,
+	0x41, 0x57,
+	0x48, 0x83, 0xEC, -1,
+	0x4C, 0x63, 0xB1, 0xD8, 0x00, 0x00, 0x00,
+	0x49, 0x8B, 0xF0,
+	0x48, 0x8B, 0xEA,
+	0x48, 0x8B, 0xD9,
+};
+
+// LAbnormalComponent::CalcDirectBuildupHitByHit(const FHitInfo& InHitInfo, int InSkillBuildupDamage, int InFireBuildupDamage, int InElectricBuildupDamage, int InAcidBuildupDamage)
+// The returned TArray goes through the hidden pResult pointer.
+typedef void*(__fastcall* CalcDirectBuildupHitByHit)(void* pAbnormalComponent, void* pResult, const void* pHitInfo, int iSkill, int iFire, int iElectric, int iAcid);
+
+// One call of CalcDirectBuildupHitByHit, pushed by the hook for the sampler thread
+struct BUILDUP_EVENT
+{
+	char* pAbnormalComponent;
+};
+
+static const size_t BUILDUP_EVENT_QUEUE_SIZE = 256;
+
 class EntityBars : public ImGuiWindow
 {
 public:
 	EntityBars();
 	~EntityBars() override;
 	void OnDraw() override;
+	size_t GetContentHash() override;
 	bool OnInitialize() override;
+	void OnQueueHooks(HookTransaction& transaction) override;
 	void OnReset() override;
 	bool OnMessage(HWND hwnd, UINT iMsg, WPARAM wParam, LPARAM lParam) override;
 private:
@@ -198,10 +375,71 @@ private:
 
 	char* pLockOnSystemStaticPtr;
 	ENTITY_PTRS target;
+	STAT_INDEX buffIndex;
+	STAT_INDEX maxStatMulIndex;
 	GetMaxDurability fnGetMaxDurability;
+	std::unique_ptr<FunctionHook> pBuildupHook;
+	EntityTable nearby;
+	bool bShowNearby;
+	Camera camera; // Read by the sampler thread, projects on the render thread
+	bool bShowNameplates;
+	DamageMeter damageMeter; // Only used by the sampler thread
+	bool bShowDamageMeter;
+
+	// Regeneration estimates, only used by the sampler thread
+	utility::LinearTrend postureTrend;
+	utility::LinearTrend staggerTrend;
+	char* pTrendTarget;
+	int iLastPosture;
+	std::chrono::steady_clock::time_point lastTrendSample;
+	bool bShowRegen;
+
+	utility::TripleBuffer<ENTITY_SNAPSHOT> snapshots;
+	ENTITY_SNAPSHOT lastSnapshot; // Last published one, its buildup is read again on hits. Only used by the sampler thread
+
+	// Bar labels, only used by OnDraw
+	BAR_TEXT<int, int> basicStatTexts[4]; // Health, Stamina, Posture, Stagger
+	BAR_TEXT<float> staggerDurationText;
+	BAR_TEXT<std::string_view, int, int> buildupTexts[E_TYPE::COUNT];
+	BAR_TEXT<std::string_view, float> debuffTexts[E_TYPE::COUNT];
+	BAR_TEXT<int, int> durabilityTexts[MAX_WEAPONS];
+	BAR_TEXT<int, int> nearbyTexts[MAX_NEARBY];
+	BAR_TEXT<int, int> dpsText;
+	BAR_TEXT<float, int64_t> timeToKillText;
+	BAR_TEXT<int64_t> fightDamageText;
+	BAR_TEXT<float, float> postureRegenText;
+	BAR_TEXT<float> staggerBreakText;
+
+	// Bar fills interpolated between samples, only used by OnDraw
+	BAR_FILL basicStatFills[4]; // Health, Stamina, Posture, Stagger
+	BAR_FILL staggerDurationFill;
+	BAR_FILL buildupFills[E_TYPE::COUNT];
+	BAR_FILL durabilityFills[MAX_WEAPONS];
+	BAR_FILL nearbyFills[MAX_NEARBY][2]; // Health, Stagger, in the slot order of the last drawn snapshot
+	const void* pNearbyFillBase[MAX_NEARBY];
+	int iNearbyFillCount;
+	std::chrono::steady_clock::time_point frameTime;
+	std::chrono::steady_clock::time_point animationEndTime;
+	std::chrono::microseconds samplingInterval;
+	std::unique_ptr<std::jthread> pThreadUpdateEntity;
+
+	bool InitializeBuildupHook(char* pCalcDirectBuildup);
+	bool DrainBuildupEvents(ENTITY_SNAPSHOT& snapshot);
+	void UpdateEntityData(std::stop_token stopToken);
+	bool SampleTarget(ENTITY_SNAPSHOT& snapshot);
+	inline void SampleBasicStats(ENTITY_SNAPSHOT& snapshot);
+	inline void SampleElementalBuildup(ENTITY_SNAPSHOT& snapshot);
+	inline void SampleWeaponsDurability(ENTITY_SNAPSHOT& snapshot);
+	inline void SampleDamage(ENTITY_SNAPSHOT& snapshot);
+	inline void SampleRegen(ENTITY_SNAPSHOT& snapshot);
+	void SampleNearby(ENTITY_SNAPSHOT& snapshot);
 
-	//inline void ShowTestWindow(const FVector& headTagPos);
-	inline void ShowBasicStats(int iValues[], float fValues[], const ImVec2& progressBarSize);
-	inline void ShowElementalBuildup(const ImVec2& progressBarSize);
-	inline void ShowWeaponsDurability(int iValues[], const ImVec2& progressBarSize);
+	inline float GetFill(BAR_FILL& fill, float fTarget);
+	inline void MatchNearbyFills(const ENTITY_SNAPSHOT& snapshot);
+	inline void ShowBasicStats(const ENTITY_SNAPSHOT& snapshot, const ImVec2& progressBarSize);
+	inline void ShowElementalBuildup(const ENTITY_SNAPSHOT& snapshot, const ImVec2& progressBarSize);
+	inline void ShowWeaponsDurability(const ENTITY_SNAPSHOT& snapshot, const ImVec2& progressBarSize);
+	inline void ShowDamageMeter(const ENTITY_SNAPSHOT& snapshot);
+	inline void ShowNearbyEntities(const ENTITY_SNAPSHOT& snapshot, const ImVec2& progressBarSize);
+	inline void ShowNameplates(const ENTITY_SNAPSHOT& snapshot);
 };
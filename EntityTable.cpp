@@ -0,0 +1,171 @@
+#include "EntityTable.hpp"
+#include "EntityBars.hpp"
+#include "utility/PtrChain.hpp"
+#include "utility/RegionMap.hpp"
+#include <cstring>
+#include <algorithm>
+
+// Last StatList offset read by Refresh, plus the value
+static const size_t STAT_LIST_READ_SIZE = 0xE7C + sizeof(int);
+
+static const size_t HEAD_TAG_OFFSET = 0x149C;
+
+EntityTable::EntityTable() : iCount(0), pCandidate(), pBase(), pStatList(), iHealth(), iStagger(), headTag()
+{
+}
+
+EntityTable::~EntityTable()
+{
+}
+
+void EntityTable::Update(char* const* pCandidates, size_t candidateCount)
+{
+	bool bIsKnown[MAX_ENTITIES * 2] = {};
+	candidateCount = std::min(candidateCount, MAX_ENTITIES * 2);
+
+	// Drop the entities that left the list, the others keep their slot order
+	size_t count = 0;
+	for (size_t i = 0; i < iCount; ++i)
+	{
+		auto it = std::find(pCandidates, pCandidates + candidateCount, pCandidate[i]);
+		if (it == pCandidates + candidateCount)
+			continue;
+
+		bIsKnown[it - pCandidates] = true;
+
+		if (count != i)
+		{
+			pCandidate[count] = pCandidate[i];
+			pBase[count] = pBase[i];
+			pStatList[count] = pStatList[i];
+			memcpy(iHealth[count], iHealth[i], sizeof(iHealth[0]));
+			memcpy(iStagger[count], iStagger[i], sizeof(iStagger[0]));
+			headTag[count] = headTag[i];
+		}
+
+		++count;
+	}
+
+	iCount = count;
+
+	// Only the new candidates are resolved
+	for (size_t i = 0; i < candidateCount && iCount < MAX_ENTITIES; ++i)
+	{
+		if (!bIsKnown[i] && pCandidates[i] != nullptr)
+			Add(pCandidates[i]);
+	}
+}
+
+void EntityTable::Refresh()
+{
+	auto& regionMap = utility::RegionMap::GetInstance();
+
+	for (size_t i = 0; i < iCount;)
+	{
+		// Despawned between two updates, the pages are gone or the character was freed and its memory reused
+		if (!regionMap.IsReadable(pStatList[i], STAT_LIST_READ_SIZE) || !regionMap.IsReadable(pBase[i] + HEAD_TAG_OFFSET, sizeof(FVector)) ||
+			utility::PtrChain<0xD8>::Read<char*>(pBase[i]) != pBase[i])
+		{
+			Remove(i);
+			continue;
+		}
+
+		++i;
+	}
+
+	// Raw max values, the buff and multiplier lists are only indexed for the locked-on target
+	for (size_t i = 0; i < iCount; ++i)
+	{
+		iHealth[i][0] = *(int*)(pStatList[i] + 0xC);
+		iHealth[i][1] = *(int*)(pStatList[i] + 0xD2C);
+	}
+
+	for (size_t i = 0; i < iCount; ++i)
+	{
+		iStagger[i][0] = *(int*)(pStatList[i] + 0x8DC);
+		iStagger[i][1] = *(int*)(pStatList[i] + 0xE7C);
+	}
+
+	for (size_t i = 0; i < iCount; ++i)
+		headTag[i] = *(FVector*)(pBase[i] + HEAD_TAG_OFFSET);
+}
+
+void EntityTable::Clear()
+{
+	iCount = 0;
+}
+
+char* EntityTable::ResolveCharacter(char* pCandidate)
+{
+	// Characters have their instigator reference as themselves
+	if (utility::PtrChain<0xD8>::Read<char*>(pCandidate) == pCandidate)
+		return pCandidate;
+
+	// Otherwise a component, its owner holds the character
+	char* pCharacter = utility::PtrChain<0xC0, 0xD8>::Read<char*>(pCandidate).value_or(nullptr);
+	if (pCharacter == nullptr || utility::PtrChain<0xD8>::Read<char*>(pCharacter) != pCharacter)
+		return nullptr;
+
+	return pCharacter;
+}
+
+bool EntityTable::IsHostile(unsigned char bFaction)
+{
+	switch (bFaction)
+	{
+		case ENTITY_FACTION::F_MONSTER:
+		case ENTITY_FACTION::F_ALLENEMY:
+		case ENTITY_FACTION::F_MONSTER_PUPPET:
+		case ENTITY_FACTION::F_MONSTER_CARCASS:
+		case ENTITY_FACTION::F_MONSTER_REBORNER:
+		case ENTITY_FACTION::F_MONSTER_STALKER:
+		case ENTITY_FACTION::F_ENEMY_TOONLYPLAYER:
+		case ENTITY_FACTION::F_MONSTER_CARCASSNPUPPET:
+			return true;
+		default:
+			return false;
+	}
+}
+
+bool EntityTable::Add(char* pNewCandidate)
+{
+	char* pCharacter = ResolveCharacter(pNewCandidate);
+	if (pCharacter == nullptr)
+		return false;
+
+	// Several components of the same character can be candidates
+	if (std::find(pBase, pBase + iCount, pCharacter) != pBase + iCount)
+		return false;
+
+	if (!IsHostile(utility::PtrChain<0x760>::Read<unsigned char>(pCharacter).value_or(ENTITY_FACTION::F_NONE)))
+		return false;
+
+	// Filter out incomplete StatLists, same as the locked-on target
+	auto statList = utility::PtrChain<0x848, 0xE0, 0x28>::Read<LIST_DATA>(pCharacter).value_or(LIST_DATA{ nullptr, -1 });
+	if (statList.iSize < 130 || !utility::RegionMap::GetInstance().IsReadable(statList.pList, STAT_LIST_READ_SIZE))
+		return false;
+
+	pCandidate[iCount] = pNewCandidate;
+	pBase[iCount] = pCharacter;
+	pStatList[iCount] = statList.pList;
+	iHealth[iCount][0] = iHealth[iCount][1] = 0;
+	iStagger[iCount][0] = iStagger[iCount][1] = 0;
+	headTag[iCount] = FVector();
+	++iCount;
+
+	return true;
+}
+
+void EntityTable::Remove(size_t i)
+{
+	size_t moved = iCount - i - 1;
+
+	memmove(pCandidate + i, pCandidate + i + 1, moved * sizeof(pCandidate[0]));
+	memmove(pBase + i, pBase + i + 1, moved * sizeof(pBase[0]));
+	memmove(pStatList + i, pStatList + i + 1, moved * sizeof(pStatList[0]));
+	memmove(iHealth + i, iHealth + i + 1, moved * sizeof(iHealth[0]));
+	memmove(iStagger + i, iStagger + i + 1, moved * sizeof(iStagger[0]));
+	std::copy(headTag + i + 1, headTag + iCount, headTag + i);
+
+	--iCount;
+}
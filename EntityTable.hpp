@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include "Game/Vector.h"
+
+// Every nearby hostile LCharacter, stored as a struct of arrays so Refresh walks each value contiguously.
+// Update only resolves the candidates it has not seen yet, the lookups that do not change while an entity
+// is alive (character, faction, StatList) are made once when it is added.
+// Only used by the sampler thread.
+class EntityTable
+{
+public:
+	static constexpr size_t MAX_ENTITIES = 64;
+
+	EntityTable();
+	virtual ~EntityTable();
+
+	// pCandidates are lock-on candidates, either characters or components owned by one.
+	// The entities whose candidate is gone are removed, the order of the others is kept.
+	void Update(char* const* pCandidates, size_t candidateCount);
+
+	// Reads the current values of every entity, the ones whose StatList is not readable anymore are removed
+	void Refresh();
+
+	void Clear();
+
+	size_t Count() const { return iCount; }
+	char* GetBase(size_t i) const { return pBase[i]; }
+	const int* GetHealth(size_t i) const { return iHealth[i]; }
+	const int* GetStagger(size_t i) const { return iStagger[i]; }
+	const FVector& GetHeadTag(size_t i) const { return headTag[i]; }
+private:
+	size_t iCount;
+
+	// Set when added
+	char* pCandidate[MAX_ENTITIES];
+	char* pBase[MAX_ENTITIES];
+	char* pStatList[MAX_ENTITIES];
+
+	// Set by Refresh, current and max
+	int iHealth[MAX_ENTITIES][2];
+	int iStagger[MAX_ENTITIES][2];
+	FVector headTag[MAX_ENTITIES];
+
+	static char* ResolveCharacter(char* pCandidate);
+	static bool IsHostile(unsigned char bFaction);
+	bool Add(char* pNewCandidate);
+	void Remove(size_t i);
+};
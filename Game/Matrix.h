@@ -7,12 +7,33 @@
 #include "Vector4.h"
 #include "Plane.h"
 #include "Rotator.h"
-
-struct VectorRegister
+#include <cstring>
+
+// SSE matrix math on x86/x64, define PLATFORM_ENABLE_VECTORINTRINSICS to 0 to only use the scalar path
+#ifndef PLATFORM_ENABLE_VECTORINTRINSICS
+	#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+		#define PLATFORM_ENABLE_VECTORINTRINSICS 1
+	#else
+		#define PLATFORM_ENABLE_VECTORINTRINSICS 0
+	#endif
+#endif
+
+#if PLATFORM_ENABLE_VECTORINTRINSICS
+#include <xmmintrin.h>
+#endif
+
+/** 4 floats for the scalar path, always available to check the SSE one against. */
+struct ScalarVectorRegister
 {
 	float	V[4];
 };
 
+#if PLATFORM_ENABLE_VECTORINTRINSICS
+typedef __m128 VectorRegister;
+#else
+typedef ScalarVectorRegister VectorRegister;
+#endif
+
 /**
  * 4x4 matrix of floating point values.
  * Matrix-matrix multiplication happens with a pre-multiple of the transpose --
@@ -281,8 +302,12 @@ public:
 	 */
 	static inline VectorRegister MakeVectorRegister(float X, float Y, float Z, float W)
 	{
+#if PLATFORM_ENABLE_VECTORINTRINSICS
+		return _mm_setr_ps(X, Y, Z, W);
+#else
 		VectorRegister Vec = { { X, Y, Z, W } };
 		return Vec;
+#endif
 	}
 
 	/**
@@ -293,9 +318,27 @@ public:
 	 * @return VectorRegister = VecP*MatrixM
 	 */
 	static inline VectorRegister VectorTransformVector(const VectorRegister& VecP, const void* MatrixM)
+	{
+#if PLATFORM_ENABLE_VECTORINTRINSICS
+		const float* M = (const float*)MatrixM;
+
+		// VecP.x * Row0 + VecP.y * Row1 + VecP.z * Row2 + VecP.w * Row3
+		VectorRegister Result = _mm_mul_ps(_mm_shuffle_ps(VecP, VecP, _MM_SHUFFLE(0, 0, 0, 0)), _mm_loadu_ps(M + 0));
+		Result = _mm_add_ps(Result, _mm_mul_ps(_mm_shuffle_ps(VecP, VecP, _MM_SHUFFLE(1, 1, 1, 1)), _mm_loadu_ps(M + 4)));
+		Result = _mm_add_ps(Result, _mm_mul_ps(_mm_shuffle_ps(VecP, VecP, _MM_SHUFFLE(2, 2, 2, 2)), _mm_loadu_ps(M + 8)));
+		Result = _mm_add_ps(Result, _mm_mul_ps(_mm_shuffle_ps(VecP, VecP, _MM_SHUFFLE(3, 3, 3, 3)), _mm_loadu_ps(M + 12)));
+
+		return Result;
+#else
+		return VectorTransformVectorScalar(VecP, MatrixM);
+#endif
+	}
+
+	/** Scalar version of VectorTransformVector. */
+	static inline ScalarVectorRegister VectorTransformVectorScalar(const ScalarVectorRegister& VecP, const void* MatrixM)
 	{
 		typedef float Float4x4[4][4];
-		union { VectorRegister v; float f[4]; } Tmp, Result;
+		union { ScalarVectorRegister v; float f[4]; } Tmp, Result;
 		Tmp.v = VecP;
 		const Float4x4& M = *((const Float4x4*)MatrixM);
 
@@ -332,6 +375,33 @@ public:
 	}
 
 	static inline void VectorMatrixMultiply(void* Result, const void* Matrix1, const void* Matrix2)
+	{
+#if PLATFORM_ENABLE_VECTORINTRINSICS
+		const float* A = (const float*)Matrix1;
+		const float* B = (const float*)Matrix2;
+		const VectorRegister B0 = _mm_loadu_ps(B + 0);
+		const VectorRegister B1 = _mm_loadu_ps(B + 4);
+		const VectorRegister B2 = _mm_loadu_ps(B + 8);
+		const VectorRegister B3 = _mm_loadu_ps(B + 12);
+
+		// Every row of A transforms B, all of them are computed before storing since Result can be Matrix1
+		const VectorRegister R0 = VectorTransformRow(A + 0, B0, B1, B2, B3);
+		const VectorRegister R1 = VectorTransformRow(A + 4, B0, B1, B2, B3);
+		const VectorRegister R2 = VectorTransformRow(A + 8, B0, B1, B2, B3);
+		const VectorRegister R3 = VectorTransformRow(A + 12, B0, B1, B2, B3);
+
+		float* Dst = (float*)Result;
+		_mm_storeu_ps(Dst + 0, R0);
+		_mm_storeu_ps(Dst + 4, R1);
+		_mm_storeu_ps(Dst + 8, R2);
+		_mm_storeu_ps(Dst + 12, R3);
+#else
+		VectorMatrixMultiplyScalar(Result, Matrix1, Matrix2);
+#endif
+	}
+
+	/** Scalar version of VectorMatrixMultiply. */
+	static inline void VectorMatrixMultiplyScalar(void* Result, const void* Matrix1, const void* Matrix2)
 	{
 		typedef float Float4x4[4][4];
 		const Float4x4& A = *((const Float4x4*)Matrix1);
@@ -366,6 +436,102 @@ public:
 	 * @param SrcMatrix		FMatrix pointer to the Matrix to be inversed
 	 */
 	static inline void VectorMatrixInverse(void* DstMatrix, const void* SrcMatrix)
+	{
+#if PLATFORM_ENABLE_VECTORINTRINSICS
+		// Block inversion with 2x2 sub matrices, each one stored row major in a register:
+		// M = | A B |, M^-1 = 1/|M| * | X Y | with the adjugates X# = |D|A - B(D#C), Y# = |B|C - D(A#B)#,
+		//     | C D |                 | Z W |                    Z# = |C|B - A(D#C)#, W# = |A|D - C(A#B)
+		const float* Src = (const float*)SrcMatrix;
+		const VectorRegister Row0 = _mm_loadu_ps(Src + 0);
+		const VectorRegister Row1 = _mm_loadu_ps(Src + 4);
+		const VectorRegister Row2 = _mm_loadu_ps(Src + 8);
+		const VectorRegister Row3 = _mm_loadu_ps(Src + 12);
+
+		const VectorRegister A = _mm_movelh_ps(Row0, Row1);
+		const VectorRegister B = _mm_movehl_ps(Row1, Row0);
+		const VectorRegister C = _mm_movelh_ps(Row2, Row3);
+		const VectorRegister D = _mm_movehl_ps(Row3, Row2);
+
+		// (|A|, |B|, |C|, |D|)
+		const VectorRegister DetSub = _mm_sub_ps(
+			_mm_mul_ps(_mm_shuffle_ps(Row0, Row2, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(Row1, Row3, _MM_SHUFFLE(3, 1, 3, 1))),
+			_mm_mul_ps(_mm_shuffle_ps(Row0, Row2, _MM_SHUFFLE(3, 1, 3, 1)), _mm_shuffle_ps(Row1, Row3, _MM_SHUFFLE(2, 0, 2, 0))));
+		const VectorRegister DetA = _mm_shuffle_ps(DetSub, DetSub, _MM_SHUFFLE(0, 0, 0, 0));
+		const VectorRegister DetB = _mm_shuffle_ps(DetSub, DetSub, _MM_SHUFFLE(1, 1, 1, 1));
+		const VectorRegister DetC = _mm_shuffle_ps(DetSub, DetSub, _MM_SHUFFLE(2, 2, 2, 2));
+		const VectorRegister DetD = _mm_shuffle_ps(DetSub, DetSub, _MM_SHUFFLE(3, 3, 3, 3));
+
+		const VectorRegister D_C = Matrix2x2AdjMul(D, C);
+		const VectorRegister A_B = Matrix2x2AdjMul(A, B);
+
+		VectorRegister X_ = _mm_sub_ps(_mm_mul_ps(DetD, A), Matrix2x2Mul(B, D_C));
+		VectorRegister W_ = _mm_sub_ps(_mm_mul_ps(DetA, D), Matrix2x2Mul(C, A_B));
+		VectorRegister Y_ = _mm_sub_ps(_mm_mul_ps(DetB, C), Matrix2x2MulAdj(D, A_B));
+		VectorRegister Z_ = _mm_sub_ps(_mm_mul_ps(DetC, B), Matrix2x2MulAdj(A, D_C));
+
+		// |M| = |A||D| + |B||C| - tr((A#B)(D#C))
+		VectorRegister Trace = _mm_mul_ps(A_B, _mm_shuffle_ps(D_C, D_C, _MM_SHUFFLE(3, 1, 2, 0)));
+		Trace = _mm_add_ps(Trace, _mm_movehl_ps(Trace, Trace));
+		Trace = _mm_add_ps(Trace, _mm_shuffle_ps(Trace, Trace, _MM_SHUFFLE(1, 1, 1, 1)));
+		Trace = _mm_shuffle_ps(Trace, Trace, _MM_SHUFFLE(0, 0, 0, 0));
+
+		const VectorRegister DetM = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(DetA, DetD), _mm_mul_ps(DetB, DetC)), Trace);
+
+		// Adjugate signs of the 2x2 blocks
+		const VectorRegister RDet = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), DetM);
+
+		X_ = _mm_mul_ps(X_, RDet);
+		Y_ = _mm_mul_ps(Y_, RDet);
+		Z_ = _mm_mul_ps(Z_, RDet);
+		W_ = _mm_mul_ps(W_, RDet);
+
+		// Adjugate and store the blocks back as rows
+		float* Dst = (float*)DstMatrix;
+		_mm_storeu_ps(Dst + 0, _mm_shuffle_ps(X_, Y_, _MM_SHUFFLE(1, 3, 1, 3)));
+		_mm_storeu_ps(Dst + 4, _mm_shuffle_ps(X_, Y_, _MM_SHUFFLE(0, 2, 0, 2)));
+		_mm_storeu_ps(Dst + 8, _mm_shuffle_ps(Z_, W_, _MM_SHUFFLE(1, 3, 1, 3)));
+		_mm_storeu_ps(Dst + 12, _mm_shuffle_ps(Z_, W_, _MM_SHUFFLE(0, 2, 0, 2)));
+#else
+		VectorMatrixInverseScalar(DstMatrix, SrcMatrix);
+#endif
+	}
+
+#if PLATFORM_ENABLE_VECTORINTRINSICS
+	/** Row[0] * B0 + Row[1] * B1 + Row[2] * B2 + Row[3] * B3, the row elements are broadcast from memory */
+	static inline VectorRegister VectorTransformRow(const float* Row, const VectorRegister& B0, const VectorRegister& B1, const VectorRegister& B2, const VectorRegister& B3)
+	{
+		return _mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(_mm_set1_ps(Row[0]), B0), _mm_mul_ps(_mm_set1_ps(Row[1]), B1)),
+			_mm_add_ps(_mm_mul_ps(_mm_set1_ps(Row[2]), B2), _mm_mul_ps(_mm_set1_ps(Row[3]), B3)));
+	}
+
+	/** 2x2 row major matrices in one register, Vec1 * Vec2 */
+	static inline VectorRegister Matrix2x2Mul(const VectorRegister& Vec1, const VectorRegister& Vec2)
+	{
+		return _mm_add_ps(
+			_mm_mul_ps(Vec1, _mm_shuffle_ps(Vec2, Vec2, _MM_SHUFFLE(3, 0, 3, 0))),
+			_mm_mul_ps(_mm_shuffle_ps(Vec1, Vec1, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(Vec2, Vec2, _MM_SHUFFLE(1, 2, 1, 2))));
+	}
+
+	/** 2x2 row major matrices in one register, adjugate(Vec1) * Vec2 */
+	static inline VectorRegister Matrix2x2AdjMul(const VectorRegister& Vec1, const VectorRegister& Vec2)
+	{
+		return _mm_sub_ps(
+			_mm_mul_ps(_mm_shuffle_ps(Vec1, Vec1, _MM_SHUFFLE(0, 0, 3, 3)), Vec2),
+			_mm_mul_ps(_mm_shuffle_ps(Vec1, Vec1, _MM_SHUFFLE(2, 2, 1, 1)), _mm_shuffle_ps(Vec2, Vec2, _MM_SHUFFLE(1, 0, 3, 2))));
+	}
+
+	/** 2x2 row major matrices in one register, Vec1 * adjugate(Vec2) */
+	static inline VectorRegister Matrix2x2MulAdj(const VectorRegister& Vec1, const VectorRegister& Vec2)
+	{
+		return _mm_sub_ps(
+			_mm_mul_ps(Vec1, _mm_shuffle_ps(Vec2, Vec2, _MM_SHUFFLE(0, 3, 0, 3))),
+			_mm_mul_ps(_mm_shuffle_ps(Vec1, Vec1, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(Vec2, Vec2, _MM_SHUFFLE(1, 2, 1, 2))));
+	}
+#endif
+
+	/** Scalar version of VectorMatrixInverse. */
+	static inline void VectorMatrixInverseScalar(void* DstMatrix, const void* SrcMatrix)
 	{
 		typedef float Float4x4[4][4];
 		const Float4x4& M = *((const Float4x4*)SrcMatrix);
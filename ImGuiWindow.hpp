@@ -3,12 +3,19 @@
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
 
+class HookTransaction;
+
 class ImGuiWindow
 {
 public:
 	virtual ~ImGuiWindow() {};
 	virtual bool OnInitialize() = 0;
+	// Called after every OnInitialize, the queued hooks are installed together with the D3D12 ones
+	virtual void OnQueueHooks(HookTransaction& transaction) {}
 	virtual void OnReset() = 0;
 	virtual void OnDraw() = 0;
+	// Hash of everything OnDraw would show, when no window's hash changed the last frame is drawn again.
+	// Return 0 when the window must be drawn every frame.
+	virtual size_t GetContentHash() = 0;
 	virtual bool OnMessage(HWND hwnd, UINT iMsg, WPARAM wParam, LPARAM lParam) = 0;
 };
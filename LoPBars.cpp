@@ -1,13 +1,19 @@
 #include "LoPBars.hpp"
 #include <imgui.h>
+#include <imgui_internal.h>
 #include <imgui_impl_win32.h>
 #include <imgui_impl_dx12.h>
 #include "utility/Log.hpp"
 #include "EntityBars.hpp"
 #include "Splash.hpp"
 #include "ConfigManager.hpp"
+#include "utility/String.hpp"
+#include "utility/Profiler.hpp"
+#include "utility/HookTransaction.hpp"
+#include <typeinfo>
 
-LoPBars::LoPBars() : iD3D12(), hWnd(0), bIsInitialized(false), initAttemptCount(0)
+LoPBars::LoPBars() : iD3D12(), gpuTimings(), hWnd(0), bIsInitialized(false), initAttemptCount(0), lastContentHash(0),
+	initializeZone(0), renderZone(0), recordZone(0), drawZones()
 {
 	LOG_INFO("LoP Bars is initializing...");
 
@@ -15,6 +21,22 @@ LoPBars::LoPBars() : iD3D12(), hWnd(0), bIsInitialized(false), initAttemptCount(
 
 	imGuiWindows.push_back(std::make_unique<Splash>());
 	imGuiWindows.push_back(std::make_unique<EntityBars>());
+	imGuiWindows.push_back(std::make_unique<PerfStats>(gpuTimings));
+
+	auto& profiler = utility::Profiler::GetInstance();
+	initializeZone = profiler.AddZone("Initialize");
+	renderZone = profiler.AddZone("Render");
+	recordZone = profiler.AddZone("Record");
+
+	for (auto& wnd : imGuiWindows)
+	{
+		// MSVC names are prefixed with "class "
+		std::string_view name = typeid(*wnd).name();
+		if (name.starts_with("class "))
+			name.remove_prefix(6);
+
+		drawZones.push_back(profiler.AddZone(std::string("OnDraw ") + std::string(name)));
+	}
 
 	for (auto& wnd : imGuiWindows)
 	{
@@ -25,17 +47,29 @@ LoPBars::LoPBars() : iD3D12(), hWnd(0), bIsInitialized(false), initAttemptCount(
 		}
 	}
 
-	if (!HookD3D12())
+	// Every startup hook is installed by one commit
+	HookTransaction transaction;
+
+	for (auto& wnd : imGuiWindows)
+		wnd->OnQueueHooks(transaction);
+
+	if (!HookD3D12(transaction))
 	{
 		LOG_ERROR("Failed to hook D3D12. Retrying in 3 seconds...");
 		Sleep(3000);
-		if (!HookD3D12())
+		if (!HookD3D12(transaction))
 		{
 			LOG_ERROR("Failed to hook D3D12.");
 			throw std::exception("Failed to hook D3D12. This could be a conflict with another active overlay.");
 		}
 	}
 
+	if (!transaction.Commit() || !D3D12Hook::GetInstance().IsHooked())
+	{
+		LOG_ERROR("Failed to install hooks.");
+		throw std::exception("Failed to hook D3D12. This could be a conflict with another active overlay.");
+	}
+
 	LOG_INFO("D3D12 hooked!");
 }
 
@@ -46,7 +80,7 @@ LoPBars::~LoPBars()
 	Cleanup();
 }
 
-bool LoPBars::HookD3D12()
+bool LoPBars::HookD3D12(HookTransaction& transaction)
 {
 	auto &hkD3D12 = D3D12Hook::GetInstance();
 
@@ -61,7 +95,7 @@ bool LoPBars::HookD3D12()
 	hkD3D12.SetOnResizeBuffers([this]() { OnDeviceReset(); });
 	hkD3D12.SetOnResizeTarget([this]() { OnDeviceReset(); });
 
-	return hkD3D12.Hook();
+	return hkD3D12.Hook(transaction);
 }
 
 bool LoPBars::HookWindowsMsg()
@@ -105,7 +139,7 @@ bool LoPBars::Initialize()
 
 	if (!hkD3D12.IsHooked())
 	{
-		HookD3D12();
+		hkD3D12.Hook();
 		return false;
 	}
 
@@ -175,6 +209,9 @@ void LoPBars::Cleanup()
 	if (!WindowsMessageHook::GetInstance().IsHookIntact())
 		WindowsMessageHook::GetInstance().Unhook();
 
+	// The GPU may still be executing the last overlay command list
+	WaitForFence(iD3D12.iFenceValue);
+
 	if (ImGui::GetCurrentContext() != nullptr)
 	{
 		if (ImGui::GetIO().BackendRendererUserData != nullptr)
@@ -184,11 +221,7 @@ void LoPBars::Cleanup()
 		ImGui::DestroyContext();
 	}
 
-	iD3D12.frameContexts.clear();
-	iD3D12.pCmdAllocator = nullptr;
-	iD3D12.pCmdList = nullptr;
-	iD3D12.pRTVHeapDesc = nullptr;
-	iD3D12.pSRVHeapDesc = nullptr;
+	ReleaseD3D12();
 
 	imGuiWindows.clear();
 }
@@ -260,15 +293,39 @@ bool LoPBars::InitializeD3D12()
 		}
 	}
 
-	LOG_INFO("Creating command allocator...");
-	if (FAILED(device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&iD3D12.pCmdAllocator))))
+	LOG_INFO("Creating command allocators...");
+	for (auto& frameContext : iD3D12.frameContexts)
+	{
+		if (FAILED(device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&frameContext.pCmdAllocator))))
+		{
+			LOG_ERROR("Failed to create command allocator");
+			return false;
+		}
+		frameContext.iFenceValue = 0;
+		frameContext.bHasTimestamps = false;
+	}
+
+	LOG_INFO("Creating fence...");
+	if (FAILED(device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&iD3D12.pFence))))
+	{
+		LOG_ERROR("Failed to create fence");
+		return false;
+	}
+
+	iD3D12.iFenceValue = 0;
+	iD3D12.hFenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+	if (iD3D12.hFenceEvent == nullptr)
 	{
-		LOG_ERROR("Failed to create command allocator");
+		LOG_ERROR("Failed to create fence event");
 		return false;
 	}
 
+	LOG_INFO("Creating timestamp queries...");
+	if (!CreateTimestampQueries())
+		LOG_WARNING("Failed to create timestamp queries, GPU timings are disabled");
+
 	LOG_INFO("Creating command list...");
-	if (FAILED(device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, iD3D12.pCmdAllocator.Get(), nullptr, IID_PPV_ARGS(&iD3D12.pCmdList))))
+	if (FAILED(device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, iD3D12.frameContexts[0].pCmdAllocator.Get(), nullptr, IID_PPV_ARGS(&iD3D12.pCmdList))))
 	{
 		LOG_ERROR("Failed to create command list");
 		return false;
@@ -315,10 +372,103 @@ bool LoPBars::InitializeD3D12()
 	return true;
 }
 
+bool LoPBars::CreateTimestampQueries()
+{
+	auto& hkD3D12 = D3D12Hook::GetInstance();
+
+	auto device = hkD3D12.GetDevice();
+	UINT queryCount = (UINT)iD3D12.frameContexts.size() * 2;
+
+	if (FAILED(hkD3D12.GetCommandQueue()->GetTimestampFrequency(&iD3D12.iTimestampFrequency)) || iD3D12.iTimestampFrequency == 0)
+		return false;
+
+	D3D12_QUERY_HEAP_DESC queryHeapDesc = { };
+	queryHeapDesc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+	queryHeapDesc.Count = queryCount;
+
+	if (FAILED(device->CreateQueryHeap(&queryHeapDesc, IID_PPV_ARGS(&iD3D12.pTimestampHeap))))
+		return false;
+
+	D3D12_HEAP_PROPERTIES heapProperties = { };
+	heapProperties.Type = D3D12_HEAP_TYPE_READBACK;
+
+	D3D12_RESOURCE_DESC bufferDesc = { };
+	bufferDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+	bufferDesc.Width = queryCount * sizeof(UINT64);
+	bufferDesc.Height = 1;
+	bufferDesc.DepthOrArraySize = 1;
+	bufferDesc.MipLevels = 1;
+	bufferDesc.SampleDesc.Count = 1;
+	bufferDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+
+	if (FAILED(device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &bufferDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&iD3D12.pTimestampBuffer))))
+	{
+		iD3D12.pTimestampHeap = nullptr;
+		return false;
+	}
+
+	return true;
+}
+
+void LoPBars::ReadTimestamps(UINT frameIndex)
+{
+	auto& frameContext = iD3D12.frameContexts[frameIndex];
+
+	// Only called once the fence of the frame context was reached, the resolved values are final
+	if (!frameContext.bHasTimestamps)
+		return;
+
+	frameContext.bHasTimestamps = false;
+
+	D3D12_RANGE readRange = { frameIndex * 2 * sizeof(UINT64), (frameIndex + 1) * 2 * sizeof(UINT64) };
+	D3D12_RANGE writeRange = { 0, 0 };
+	UINT64* pTimestamps;
+
+	if (FAILED(iD3D12.pTimestampBuffer->Map(0, &readRange, (void**)&pTimestamps)))
+		return;
+
+	UINT64 iBegin = pTimestamps[frameIndex * 2];
+	UINT64 iEnd = pTimestamps[frameIndex * 2 + 1];
+
+	iD3D12.pTimestampBuffer->Unmap(0, &writeRange);
+
+	if (iEnd >= iBegin)
+		gpuTimings.Add((float)((double)(iEnd - iBegin) * 1000.0 / (double)iD3D12.iTimestampFrequency));
+}
+
+void LoPBars::ReleaseD3D12()
+{
+	if (iD3D12.hFenceEvent != nullptr)
+	{
+		CloseHandle(iD3D12.hFenceEvent);
+		iD3D12.hFenceEvent = nullptr;
+	}
+
+	iD3D12.frameContexts.clear();
+	iD3D12.pCmdList = nullptr;
+	iD3D12.pFence = nullptr;
+	iD3D12.iFenceValue = 0;
+	iD3D12.pTimestampHeap = nullptr;
+	iD3D12.pTimestampBuffer = nullptr;
+	iD3D12.pRTVHeapDesc = nullptr;
+	iD3D12.pSRVHeapDesc = nullptr;
+}
+
+void LoPBars::WaitForFence(UINT64 iFenceValue)
+{
+	if (iD3D12.pFence == nullptr || iD3D12.hFenceEvent == nullptr || iD3D12.pFence->GetCompletedValue() >= iFenceValue)
+		return;
+
+	if (SUCCEEDED(iD3D12.pFence->SetEventOnCompletion(iFenceValue, iD3D12.hFenceEvent)))
+		WaitForSingleObject(iD3D12.hFenceEvent, INFINITE);
+}
+
 void LoPBars::OnPresentD3D12()
 {
 	if (!bIsInitialized)
 	{
+		utility::ScopedTimer initializeTimer(initializeZone);
+
 		if (!Initialize())
 		{
 			LOG_ERROR("Failed to initialize! Attempt " << std::dec << initAttemptCount + 1 << "/" << MAX_INIT_ATTEMPTS);
@@ -339,18 +489,48 @@ void LoPBars::OnPresentD3D12()
 	auto& hkD3D12Hook = D3D12Hook::GetInstance();
 	auto swapChain = hkD3D12Hook.GetSwapChain();
 
-	ImGui_ImplDX12_NewFrame();
-	ImGui_ImplWin32_NewFrame();
-	ImGui::NewFrame();
+	// The draw data stays valid until the next NewFrame, replay it when no window changed what it shows.
+	// Input is queued by the message hook and only consumed by NewFrame, which may trickle it over several
+	// frames, so build frames until the queue is empty or it grows for as long as the content is unchanged.
+	const size_t contentHash = GetContentHash();
+	const bool bHasInput = !ImGui::GetCurrentContext()->InputEventsQueue.empty();
+	const bool bIsUnchanged = !bHasInput && contentHash != 0 && contentHash == lastContentHash && ImGui::GetDrawData() != nullptr;
+	lastContentHash = contentHash;
 
-	ImGui::GetIO().ConfigFlags |= ImGuiConfigFlags_NoMouseCursorChange;
+	if (!bIsUnchanged)
+	{
+		ImGui_ImplDX12_NewFrame();
+		ImGui_ImplWin32_NewFrame();
+		ImGui::NewFrame();
 
-	for (auto &wnd : imGuiWindows)
-		wnd->OnDraw();
-	ImGui::EndFrame();
+		ImGui::GetIO().ConfigFlags |= ImGuiConfigFlags_NoMouseCursorChange;
 
-	auto& frameContext = iD3D12.frameContexts[swapChain->GetCurrentBackBufferIndex()];
-	iD3D12.pCmdAllocator->Reset();
+		for (size_t i = 0; i < imGuiWindows.size(); ++i)
+		{
+			utility::ScopedTimer drawTimer(drawZones[i]);
+			imGuiWindows[i]->OnDraw();
+		}
+		ImGui::EndFrame();
+
+		utility::ScopedTimer renderTimer(renderZone);
+		ImGui::Render();
+	}
+
+	// Nothing visible, don't record or submit anything
+	auto pDrawData = ImGui::GetDrawData();
+	if (pDrawData == nullptr || !pDrawData->Valid || pDrawData->TotalVtxCount == 0)
+		return;
+
+	utility::ScopedTimer recordTimer(recordZone);
+
+	const UINT frameIndex = swapChain->GetCurrentBackBufferIndex();
+	auto& frameContext = iD3D12.frameContexts[frameIndex];
+
+	// Only wait when the allocator of this back buffer is still in use by the GPU
+	WaitForFence(frameContext.iFenceValue);
+	frameContext.pCmdAllocator->Reset();
+
+	ReadTimestamps(frameIndex);
 
 	D3D12_RESOURCE_BARRIER barrier{};
 	barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
@@ -360,13 +540,22 @@ void LoPBars::OnPresentD3D12()
 	barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_PRESENT;
 	barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_RENDER_TARGET;
 
-	iD3D12.pCmdList->Reset(iD3D12.pCmdAllocator.Get(), NULL);
+	iD3D12.pCmdList->Reset(frameContext.pCmdAllocator.Get(), NULL);
 	iD3D12.pCmdList->ResourceBarrier(1, &barrier);
 	iD3D12.pCmdList->OMSetRenderTargets(1, &frameContext.hCPUDesc, FALSE, NULL);
 	iD3D12.pCmdList->SetDescriptorHeaps(1, iD3D12.pSRVHeapDesc.GetAddressOf());
 
-	ImGui::Render();
-	ImGui_ImplDX12_RenderDrawData(ImGui::GetDrawData(), iD3D12.pCmdList.Get());
+	if (iD3D12.pTimestampHeap != nullptr)
+		iD3D12.pCmdList->EndQuery(iD3D12.pTimestampHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, frameIndex * 2);
+
+	ImGui_ImplDX12_RenderDrawData(pDrawData, iD3D12.pCmdList.Get());
+
+	if (iD3D12.pTimestampHeap != nullptr)
+	{
+		iD3D12.pCmdList->EndQuery(iD3D12.pTimestampHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, frameIndex * 2 + 1);
+		iD3D12.pCmdList->ResolveQueryData(iD3D12.pTimestampHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, frameIndex * 2, 2, iD3D12.pTimestampBuffer.Get(), frameIndex * 2 * sizeof(UINT64));
+		frameContext.bHasTimestamps = true;
+	}
 
 	barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_RENDER_TARGET;
 	barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_PRESENT;
@@ -375,6 +564,25 @@ void LoPBars::OnPresentD3D12()
 	iD3D12.pCmdList->Close();
 	ID3D12CommandList* const pCmdList[] = { iD3D12.pCmdList.Get() };
 	hkD3D12Hook.GetCommandQueue()->ExecuteCommandLists(1, pCmdList);
+
+	if (SUCCEEDED(hkD3D12Hook.GetCommandQueue()->Signal(iD3D12.pFence.Get(), iD3D12.iFenceValue + 1)))
+		frameContext.iFenceValue = ++iD3D12.iFenceValue;
+}
+
+size_t LoPBars::GetContentHash()
+{
+	size_t result = utility::hash(nullptr, 0);
+
+	for (auto &wnd : imGuiWindows)
+	{
+		size_t windowHash = wnd->GetContentHash();
+		if (windowHash == 0)
+			return 0;
+
+		result = utility::hash(&windowHash, sizeof(size_t), result);
+	}
+
+	return result;
 }
 
 void LoPBars::OnPostPresentD3D12()
@@ -385,6 +593,10 @@ void LoPBars::OnPostPresentD3D12()
 void LoPBars::OnDeviceReset()
 {
 	bIsInitialized = false;
+	lastContentHash = 0;
+
+	// The GPU may still be executing the last overlay command list
+	WaitForFence(iD3D12.iFenceValue);
 
 	if (ImGui::GetCurrentContext() != nullptr)
 	{
@@ -395,11 +607,7 @@ void LoPBars::OnDeviceReset()
 		ImGui::DestroyContext();
 	}
 
-	iD3D12.frameContexts.clear();
-	iD3D12.pCmdAllocator = nullptr;
-	iD3D12.pCmdList = nullptr;
-	iD3D12.pRTVHeapDesc = nullptr;
-	iD3D12.pSRVHeapDesc = nullptr;
+	ReleaseD3D12();
 
 	for (auto &wnd : imGuiWindows)
 		wnd->OnReset();
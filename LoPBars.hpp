@@ -7,6 +7,7 @@
 #include "D3D12HOOK.hpp"
 #include "WindowsMessageHook.hpp"
 #include "ImGuiWindow.hpp"
+#include "PerfStats.hpp"
 
 #define MAX_INIT_ATTEMPTS 3
 
@@ -16,6 +17,9 @@ typedef struct _D3D12_FRAME_CONTEXT
 {
 	ComPtr<ID3D12Resource> pRTV;
 	D3D12_CPU_DESCRIPTOR_HANDLE hCPUDesc;
+	ComPtr<ID3D12CommandAllocator> pCmdAllocator;
+	UINT64 iFenceValue; // Fence value signaled after the last command list recorded with pCmdAllocator
+	bool bHasTimestamps; // The last command list resolved its timestamps into the readback buffer
 } *PD3D12_FRAME_CONTEXT, D3D12_FRAME_CONTEXT;
 
 typedef struct _D3D12_INTERFACE
@@ -24,8 +28,15 @@ typedef struct _D3D12_INTERFACE
 
 	ComPtr<ID3D12DescriptorHeap> pRTVHeapDesc;
 	ComPtr<ID3D12DescriptorHeap> pSRVHeapDesc;
-	ComPtr<ID3D12CommandAllocator> pCmdAllocator;
 	ComPtr<ID3D12GraphicsCommandList> pCmdList;
+	ComPtr<ID3D12Fence> pFence;
+	HANDLE hFenceEvent;
+	UINT64 iFenceValue;
+
+	// Two timestamps per frame context around the overlay pass, optional
+	ComPtr<ID3D12QueryHeap> pTimestampHeap;
+	ComPtr<ID3D12Resource> pTimestampBuffer;
+	UINT64 iTimestampFrequency;
 } *PD3D12_INTERFACE, D3D12_INTERFACE;
 
 class LoPBars
@@ -47,15 +58,28 @@ private:
 	LoPBars();
 	HWND hWnd;
 	D3D12_INTERFACE iD3D12;
+	FRAME_TIMINGS gpuTimings;
 	std::vector<std::unique_ptr<ImGuiWindow>> imGuiWindows;
 	bool bIsInitialized;
 	int initAttemptCount;
-	bool HookD3D12();
+	size_t lastContentHash;
+
+	// Profiler zones of the present path
+	size_t initializeZone;
+	size_t renderZone;
+	size_t recordZone;
+	std::vector<size_t> drawZones; // One per window
+	bool HookD3D12(HookTransaction& transaction);
 	bool HookWindowsMsg();
 	bool Initialize();
 	void Cleanup();
 	void ConfigImGui();
 	bool InitializeD3D12();
+	void ReleaseD3D12();
+	void WaitForFence(UINT64 iFenceValue);
+	bool CreateTimestampQueries();
+	void ReadTimestamps(UINT frameIndex);
+	size_t GetContentHash();
 	void OnPresentD3D12();
 	void OnPostPresentD3D12();
 	void OnDeviceReset();
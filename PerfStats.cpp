@@ -0,0 +1,101 @@
+#include "PerfStats.hpp"
+#include "ConfigManager.hpp"
+#include "utility/String.hpp"
+#include "utility/Log.hpp"
+
+PerfStats::PerfStats(const FRAME_TIMINGS& gpuTimings) : bShowWindow(false), gpuTimings(gpuTimings)
+{
+}
+
+PerfStats::~PerfStats()
+{
+
+}
+
+bool PerfStats::OnInitialize()
+{
+	bShowWindow = ConfigManager::GetInstance().Get<int>("ShowPerfStats").value_or(0);
+	return true;
+}
+
+void PerfStats::OnReset()
+{
+
+}
+
+void PerfStats::ShowTimings(const char* szName, const FRAME_TIMINGS& timings)
+{
+	ImGui::SeparatorText(szName);
+
+	if (timings.Count() == 0)
+	{
+		ImGui::Text("No samples");
+		return;
+	}
+
+	ImGui::Text("min %.3f  avg %.3f  p99 %.3f ms", timings.GetMin(), timings.GetAverage(), timings.GetPercentile(0.99f));
+
+	ImGui::PushID(szName);
+	ImGui::PlotLines("##Timings", [](void* data, int idx) { return ((const FRAME_TIMINGS*)data)->Get(idx); },
+		(void*)&timings, (int)timings.Count(), 0, nullptr, 0.0f, FLT_MAX, ImVec2(260.0f, 40.0f));
+	ImGui::PopID();
+}
+
+void PerfStats::OnDraw()
+{
+	if (!bShowWindow)
+		return;
+
+	auto viewport = ImGui::GetMainViewport();
+	constexpr auto PAD = 10.0f;
+
+	ImGui::SetNextWindowPos(ImVec2(viewport->WorkPos.x + PAD, viewport->WorkPos.y + viewport->WorkSize.y - PAD), ImGuiCond_Always, ImVec2(0.0f, 1.0f));
+	ImGui::SetNextWindowBgAlpha(0.5f);
+
+	ImGuiWindowFlags windowFlags = ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing |
+		ImGuiWindowFlags_NoNav | ImGuiWindowFlags_NoInputs | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoDecoration;
+
+	if (ImGui::Begin("Perf Stats", nullptr, windowFlags))
+	{
+		ShowTimings("GPU overlay pass", gpuTimings);
+
+		utility::Profiler::GetInstance().ForEachZone([this](const utility::Profiler::ZONE& zone)
+			{
+				ShowTimings(zone.name.c_str(), zone.timings);
+			});
+	}
+	ImGui::End();
+}
+
+size_t PerfStats::GetContentHash()
+{
+	// The timings change every frame
+	if (bShowWindow)
+		return 0;
+
+	return utility::hash(&bShowWindow, sizeof(bool));
+}
+
+bool PerfStats::OnMessage(HWND hwnd, UINT iMsg, WPARAM wParam, LPARAM lParam)
+{
+	if (iMsg == WM_KEYDOWN && wParam == VK_END)
+	{
+		if (GetKeyState(VK_CONTROL) < 0)
+		{
+			auto wsTracePath = ConfigManager::GetInstance().GetFilePath(TRACE_FILE_NAME);
+
+			if (utility::Profiler::GetInstance().ExportChromeTrace(wsTracePath))
+				LOG_INFO("Trace exported");
+			else
+				LOG_ERROR("Failed to export trace");
+
+			return false;
+		}
+
+		bShowWindow = !bShowWindow;
+		ConfigManager::GetInstance().Set<int>("ShowPerfStats", bShowWindow);
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "ImGuiWindow.hpp"
+#include "imgui.h"
+#include "utility/Profiler.hpp"
+
+typedef utility::Profiler::TIMINGS FRAME_TIMINGS;
+
+// Debug window with the cost of the overlay, toggled with END.
+// CTRL+END writes the recorded CPU zones as a Chrome trace next to the config file.
+class PerfStats : public ImGuiWindow
+{
+public:
+	PerfStats(const FRAME_TIMINGS& gpuTimings);
+	~PerfStats() override;
+	bool OnInitialize() override;
+	void OnReset() override;
+	void OnDraw() override;
+	size_t GetContentHash() override;
+	bool OnMessage(HWND hwnd, UINT iMsg, WPARAM wParam, LPARAM lParam) override;
+private:
+	bool bShowWindow;
+	const FRAME_TIMINGS& gpuTimings;
+
+	inline void ShowTimings(const char* szName, const FRAME_TIMINGS& timings);
+};
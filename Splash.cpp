@@ -1,6 +1,7 @@
 #include "Splash.hpp"
 #include "ImGui.h"
 #include "ConfigManager.hpp"
+#include "utility/String.hpp"
 
 Splash::Splash() : bIsExpired(false), bIsFirstTime(true), startTime(), splashDuration()
 {
@@ -52,6 +53,16 @@ void Splash::OnDraw()
 		ShowSplashWindow();
 }
 
+size_t Splash::GetContentHash()
+{
+	// The content is static, it only changes once the splash expires
+	bool bShouldExpire = bIsExpired || (startTime > std::chrono::high_resolution_clock::time_point(0s) &&
+		std::chrono::high_resolution_clock::now() - startTime > splashDuration);
+
+	bool state[] = { bShouldExpire, bIsFirstTime };
+	return utility::hash(state, sizeof(state));
+}
+
 bool Splash::OnMessage(HWND hwnd, UINT iMsg, WPARAM wParam, LPARAM lParam)
 {
 	return true;
@@ -17,6 +17,7 @@ public:
 	bool OnInitialize() override;
 	void OnReset() override;
 	void OnDraw() override;
+	size_t GetContentHash() override;
 	bool OnMessage(HWND hwnd, UINT iMsg, WPARAM wParam, LPARAM lParam) override;
 private:
 	bool bIsExpired;
@@ -4,7 +4,6 @@
 #include <vector>
 #include <mutex>
 #include "utility/Log.hpp"
-#include "utility/Thread.hpp"
 #include "WindowsMessageHook.hpp"
 
 static std::recursive_mutex gProcMutex;
@@ -42,8 +41,6 @@ WindowsMessageHook::~WindowsMessageHook()
 
 	LOG_INFO("Destroying WindowsMessageHook");
 
-	utility::ThreadSuspender suspender;
-
 	Unhook();
 }
 
@@ -63,9 +60,8 @@ bool WindowsMessageHook::Hook(HWND hwnd)
 
 	LOG_INFO("Hooking Windows message handler...");
 
-	utility::ThreadSuspender suspender;
-
-	// Save the original window procedure.
+	// No thread suspension, the swap is a single SetWindowLongPtr. The original is saved first
+	// so a message dispatched right after the swap already finds it.
 	fnOriginalProc = (WNDPROC)GetWindowLongPtr(hwnd, GWLP_WNDPROC);
 
 	// Set it to our "hook" procedure.
@@ -3,6 +3,7 @@
 #include "utility/Log.hpp"
 #include <tlhelp32.h>
 #include "LoPBars.hpp"
+#include "ConfigManager.hpp"
 
 #define PROXY_DLL L"XInput1_4.dll"
 
@@ -94,6 +95,8 @@ static DWORD WINAPI InitializeProxy(LPVOID lpThreadParameter)
 {
 	SETUP_CONSOLE(L"LoP Bars");
 
+	utility::Logger::GetInstance().Open(ConfigManager::GetInstance().GetFilePath(LOG_FILE_NAME));
+
 	LOG_INFO("LoP Bars DLL loaded!");
 	LOG_INFO("Loading target library " << PROXY_DLL << "...");
 
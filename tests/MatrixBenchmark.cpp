@@ -0,0 +1,104 @@
+// Time per call of the scalar and SSE matrix multiply, transform and inverse, best of a few runs
+
+#include "Game/Matrix.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#if !PLATFORM_ENABLE_VECTORINTRINSICS
+#error "Build with SSE2, the benchmark compares the SSE path against the scalar one"
+#endif
+
+static constexpr size_t MATRIX_COUNT = 4096; // Fits in L2, the math is timed instead of the memory
+static constexpr int PASS_COUNT = 256;
+static constexpr int RUN_COUNT = 5;
+
+// Results are folded in here so the calls can't be optimized out, every component is used
+static volatile float gSink;
+
+template <typename Function>
+static double TimeNsPerCall(Function&& function)
+{
+	double bestNs = 1e30;
+
+	for (int i = 0; i < RUN_COUNT; ++i)
+	{
+		auto start = std::chrono::steady_clock::now();
+		for (int pass = 0; pass < PASS_COUNT; ++pass)
+			function();
+		double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+		bestNs = std::min(bestNs, ns / (PASS_COUNT * MATRIX_COUNT));
+	}
+
+	return bestNs;
+}
+
+int main()
+{
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> distribution(-100.0f, 100.0f);
+
+	std::vector<FMatrix> matrices(MATRIX_COUNT);
+	std::vector<FVector4> vectors(MATRIX_COUNT);
+	for (size_t i = 0; i < MATRIX_COUNT; ++i)
+	{
+		for (int j = 0; j < 16; ++j)
+			(&matrices[i].M[0][0])[j] = distribution(rng);
+		vectors[i] = FVector4(distribution(rng), distribution(rng), distribution(rng), 1.0f);
+	}
+
+	const FMatrix& viewProjection = matrices[0];
+	std::vector<FMatrix> results(MATRIX_COUNT);
+
+	struct
+	{
+		const char* szName;
+		double scalarNs;
+		double sseNs;
+	} rows[] = {
+		{
+			"Multiply",
+			TimeNsPerCall([&]() { for (size_t i = 0; i < MATRIX_COUNT; ++i) FMatrix::VectorMatrixMultiplyScalar(&results[i], &matrices[i], &viewProjection); gSink = results[MATRIX_COUNT - 1].M[3][3]; }),
+			TimeNsPerCall([&]() { for (size_t i = 0; i < MATRIX_COUNT; ++i) FMatrix::VectorMatrixMultiply(&results[i], &matrices[i], &viewProjection); gSink = results[MATRIX_COUNT - 1].M[3][3]; }),
+		},
+		{
+			"Inverse",
+			TimeNsPerCall([&]() { for (size_t i = 0; i < MATRIX_COUNT; ++i) FMatrix::VectorMatrixInverseScalar(&results[i], &matrices[i]); gSink = results[MATRIX_COUNT - 1].M[3][3]; }),
+			TimeNsPerCall([&]() { for (size_t i = 0; i < MATRIX_COUNT; ++i) FMatrix::VectorMatrixInverse(&results[i], &matrices[i]); gSink = results[MATRIX_COUNT - 1].M[3][3]; }),
+		},
+		{
+			// One matrix for every position, like the head tags of a frame
+			"Transform",
+			TimeNsPerCall([&]()
+			{
+				float fSum = 0.0f;
+				for (size_t i = 0; i < MATRIX_COUNT; ++i)
+				{
+					const ScalarVectorRegister v = { { vectors[i].X, vectors[i].Y, vectors[i].Z, vectors[i].W } };
+					const ScalarVectorRegister r = FMatrix::VectorTransformVectorScalar(v, &viewProjection);
+					fSum += r.V[0] + r.V[1] + r.V[2] + r.V[3];
+				}
+				gSink = fSum;
+			}),
+			TimeNsPerCall([&]()
+			{
+				float fSum = 0.0f;
+				for (size_t i = 0; i < MATRIX_COUNT; ++i)
+				{
+					const FVector4 r = viewProjection.TransformFVector4(vectors[i]);
+					fSum += r.X + r.Y + r.Z + r.W;
+				}
+				gSink = fSum;
+			}),
+		},
+	};
+
+	std::printf("%-10s %10s %10s %8s\n", "", "Scalar", "SSE", "Speedup");
+
+	for (auto& row : rows)
+		std::printf("%-10s %7.2f ns %7.2f ns %7.2fx\n", row.szName, row.scalarNs, row.sseNs, row.scalarNs / row.sseNs);
+
+	return 0;
+}
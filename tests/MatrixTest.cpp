@@ -0,0 +1,153 @@
+// The SSE multiply, transform and inverse of FMatrix must stay within float rounding of their *Scalar reference
+
+#include "Test.hpp"
+#include "Game/Matrix.h"
+#include <cfloat>
+#include <cmath>
+#include <random>
+
+#if !PLATFORM_ENABLE_VECTORINTRINSICS
+#error "Build with SSE2, the test compares the SSE path against the scalar one"
+#endif
+
+// Each result element is a 4 term dot product, its rounding error stays below
+// 4 ulps of the sum of the magnitudes of the terms
+static constexpr float DOT_TOLERANCE = 4.0f * FLT_EPSILON;
+
+// The inverses differ by a few 1e-3 when their translation row holds world positions (~1e4),
+// relative to the largest element of the inverse that stays under 1e-6
+static constexpr float INVERSE_TOLERANCE = 1e-5f;
+
+static std::mt19937 gRng(4321);
+
+static float Random(float fMin, float fMax)
+{
+	return std::uniform_real_distribution<float>(fMin, fMax)(gRng);
+}
+
+static FMatrix RandomMatrix(float fRange)
+{
+	FMatrix result;
+	for (int i = 0; i < 4; ++i)
+	{
+		for (int j = 0; j < 4; ++j)
+			result.M[i][j] = Random(-fRange, fRange);
+	}
+	return result;
+}
+
+// Rotation, scale and a translation in world units, the kind of matrix the camera code inverts
+static FMatrix RandomTransform()
+{
+	FMatrix scale;
+	scale.SetIdentity();
+	scale.M[0][0] = Random(0.5f, 2.0f);
+	scale.M[1][1] = Random(0.5f, 2.0f);
+	scale.M[2][2] = Random(0.5f, 2.0f);
+
+	return scale * FInverseRotationMatrix(FRotator(Random(-89.0f, 89.0f), Random(-180.0f, 180.0f), Random(-180.0f, 180.0f))) *
+		FTranslationMatrix(FVector(Random(-1e5f, 1e5f), Random(-1e5f, 1e5f), Random(-1e4f, 1e4f)));
+}
+
+// Same construction as Camera::BuildViewProjectionMatrix, with a finite far plane so it can be inverted
+static FMatrix RandomViewProjection()
+{
+	FMatrix viewRotationMatrix = FInverseRotationMatrix(FRotator(Random(-89.0f, 89.0f), Random(-180.0f, 180.0f), 0.0f)) * FMatrix(
+		FPlane(0, 0, 1, 0),
+		FPlane(1, 0, 0, 0),
+		FPlane(0, 1, 0, 0),
+		FPlane(0, 0, 0, 1)
+	);
+
+	const float HalfFOV = FMath::DegreesToRadians(Random(60.0f, 110.0f) / 2.f);
+
+	return FTranslationMatrix(FVector(Random(-1e5f, 1e5f), Random(-1e5f, 1e5f), Random(-1e4f, 1e4f))) * viewRotationMatrix *
+		FReversedZPerspectiveMatrix(HalfFOV, HalfFOV, Random(0.4f, 1.0f), 1.0f, 10.0f, 1e5f);
+}
+
+static void TestMultiply(const FMatrix& a, const FMatrix& b, const char* szCase)
+{
+	FMatrix expected, result;
+	FMatrix::VectorMatrixMultiplyScalar(&expected, &a, &b);
+	FMatrix::VectorMatrixMultiply(&result, &a, &b);
+
+	for (int i = 0; i < 4; ++i)
+	{
+		for (int j = 0; j < 4; ++j)
+		{
+			float fMagnitude = 0.0f;
+			for (int k = 0; k < 4; ++k)
+				fMagnitude += std::abs(a.M[i][k] * b.M[k][j]);
+
+			const float fError = std::abs(result.M[i][j] - expected.M[i][j]);
+			CHECK(fError <= DOT_TOLERANCE * fMagnitude + FLT_MIN, "%s: multiply [%d][%d] SSE %g, scalar %g", szCase, i, j, result.M[i][j], expected.M[i][j]);
+		}
+	}
+
+	// Result aliasing the first operand, like operator*=
+	FMatrix aliased = a;
+	FMatrix::VectorMatrixMultiply(&aliased, &aliased, &b);
+	CHECK(memcmp(&aliased, &result, sizeof(FMatrix)) == 0, "%s: multiply into its own operand differs", szCase);
+}
+
+static void TestTransform(const FMatrix& m, const FVector4& v, const char* szCase)
+{
+	const ScalarVectorRegister scalarV = { { v.X, v.Y, v.Z, v.W } };
+	const ScalarVectorRegister expected = FMatrix::VectorTransformVectorScalar(scalarV, &m);
+	const FVector4 result = m.TransformFVector4(v);
+	const float fResult[4] = { result.X, result.Y, result.Z, result.W };
+
+	for (int j = 0; j < 4; ++j)
+	{
+		const float fMagnitude = std::abs(v.X * m.M[0][j]) + std::abs(v.Y * m.M[1][j]) + std::abs(v.Z * m.M[2][j]) + std::abs(v.W * m.M[3][j]);
+		const float fError = std::abs(fResult[j] - expected.V[j]);
+		CHECK(fError <= DOT_TOLERANCE * fMagnitude + FLT_MIN, "%s: transform [%d] SSE %g, scalar %g", szCase, j, fResult[j], expected.V[j]);
+	}
+}
+
+static void TestInverse(const FMatrix& m, const char* szCase)
+{
+	FMatrix expected, result;
+	FMatrix::VectorMatrixInverseScalar(&expected, &m);
+	FMatrix::VectorMatrixInverse(&result, &m);
+
+	float fLargest = 0.0f, fError = 0.0f;
+	for (int i = 0; i < 4; ++i)
+	{
+		for (int j = 0; j < 4; ++j)
+		{
+			fLargest = std::max(fLargest, std::abs(expected.M[i][j]));
+			fError = std::max(fError, std::abs(result.M[i][j] - expected.M[i][j]));
+		}
+	}
+
+	CHECK(std::isfinite(fError) && fError <= INVERSE_TOLERANCE * fLargest, "%s: inverse differs by %g, largest element %g", szCase, fError, fLargest);
+}
+
+int main()
+{
+	for (int iteration = 0; iteration < 10000; ++iteration)
+	{
+		const FMatrix a = RandomMatrix(100.0f);
+		const FMatrix b = RandomMatrix(100.0f);
+		TestMultiply(a, b, "random");
+		TestTransform(a, FVector4(Random(-1e5f, 1e5f), Random(-1e5f, 1e5f), Random(-1e5f, 1e5f), 1.0f), "random");
+
+		const FMatrix transform = RandomTransform();
+		TestMultiply(transform, RandomTransform(), "transform");
+		TestInverse(transform, "transform");
+
+		const FMatrix viewProjection = RandomViewProjection();
+		TestTransform(viewProjection, FVector4(Random(-1e5f, 1e5f), Random(-1e5f, 1e5f), Random(-1e4f, 1e4f), 1.0f), "view projection");
+		TestInverse(viewProjection, "view projection");
+	}
+
+	// Exact, signed zeros aside
+	FMatrix identity, identityInverse;
+	identity.SetIdentity();
+	FMatrix::VectorMatrixInverse(&identityInverse, &identity);
+	for (int i = 0; i < 16; ++i)
+		CHECK((&identityInverse.M[0][0])[i] == (&identity.M[0][0])[i], "identity inverse [%d][%d] is %g", i / 4, i % 4, (&identityInverse.M[0][0])[i]);
+
+	return TestResult();
+}
@@ -0,0 +1,90 @@
+// Time of each scanner over a 128 MB buffer with the only match at its end, best of a few runs
+
+#include "utility/ScanKernels.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace utility;
+
+static constexpr size_t BUFFER_SIZE = 128 * 1024 * 1024;
+static constexpr int RUN_COUNT = 5;
+
+static double TimeScan(ScanFunction fnScan, const SCAN_PATTERN& pattern, const std::vector<unsigned char>& memory, const unsigned char* pExpected)
+{
+	double bestMs = 1e30;
+
+	for (int i = 0; i < RUN_COUNT; ++i)
+	{
+		auto start = std::chrono::steady_clock::now();
+		const unsigned char* pMatch = fnScan(pattern, memory.data(), memory.data() + memory.size());
+		double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		if (pMatch != pExpected)
+		{
+			std::printf("Wrong match\n");
+			return -1.0;
+		}
+
+		bestMs = std::min(bestMs, ms);
+	}
+
+	return bestMs;
+}
+
+int main()
+{
+	// Random bytes with the frequent x64 opcodes over represented, like the .text section of the game
+	static const unsigned char commonBytes[] = { 0x00, 0x48, 0x89, 0x8B, 0x4C, 0x24, 0xE8, 0xFF, 0x0F, 0x85, 0xCC };
+	std::mt19937 rng(42);
+	std::vector<unsigned char> memory(BUFFER_SIZE);
+	for (auto& b : memory)
+	{
+		unsigned int r = rng();
+		b = (r & 1) ? commonBytes[(r >> 1) % sizeof(commonBytes)] : (unsigned char)(r >> 8);
+	}
+
+	// RIP relative load and test, common bytes first and a rarer one further in
+	const short aobPattern[] = { 0x48, 0x8B, 0x1D, -1, -1, -1, -1, 0x48, 0x85, 0xDB, 0x74, -1, 0x41, 0xB0, 0x01 };
+	const size_t patternCount = sizeof(aobPattern) / sizeof(short);
+	const SCAN_PATTERN pattern = PreparePattern(aobPattern, patternCount);
+
+	// Clear accidental matches, then plant the only one at the end
+	for (const unsigned char* p; (p = ScanScalar(pattern, memory.data(), memory.data() + memory.size())) != nullptr;)
+		memory[p - memory.data() + pattern.anchorFirst] ^= 0xFF;
+
+	unsigned char* pExpected = memory.data() + memory.size() - patternCount;
+	for (size_t i = 0; i < patternCount; ++i)
+		pExpected[i] = aobPattern[i] == -1 ? 0x90 : (unsigned char)aobPattern[i];
+
+	struct
+	{
+		const char* szName;
+		ScanFunction fnScan;
+	} scanners[] = {
+		{ "Scalar", ScanScalar },
+		{ "SSE2", ScanSSE2 },
+		{ "AVX2", IsAVX2Supported() ? ScanAVX2 : nullptr },
+	};
+
+	const double scalarMs = TimeScan(ScanScalar, pattern, memory, pExpected);
+
+	for (auto& scanner : scanners)
+	{
+		if (scanner.fnScan == nullptr)
+		{
+			std::printf("%-8s not supported\n", scanner.szName);
+			continue;
+		}
+
+		double ms = scanner.fnScan == ScanScalar ? scalarMs : TimeScan(scanner.fnScan, pattern, memory, pExpected);
+		if (ms < 0.0)
+			return 1;
+
+		std::printf("%-8s %8.2f ms %7.2f GB/s %6.2fx\n", scanner.szName, ms, BUFFER_SIZE / (ms * 1e6), scalarMs / ms);
+	}
+
+	return 0;
+}
@@ -0,0 +1,110 @@
+// The SSE2 and AVX2 scanners must return the same offset as the scalar one for any pattern and range
+
+#include "Test.hpp"
+#include "utility/ScanKernels.hpp"
+#include <vector>
+#include <random>
+#include <cstring>
+
+using namespace utility;
+
+static void CheckScanners(const short* aobPattern, size_t patternCount, const unsigned char* pBegin, const unsigned char* pEnd, const char* szCase)
+{
+	const SCAN_PATTERN pattern = PreparePattern(aobPattern, patternCount);
+	const unsigned char* pExpected = ScanScalar(pattern, pBegin, pEnd);
+
+	const unsigned char* pSSE2 = ScanSSE2(pattern, pBegin, pEnd);
+	CHECK(pSSE2 == pExpected, "%s: SSE2 %td, scalar %td", szCase, pSSE2 ? pSSE2 - pBegin : -1, pExpected ? pExpected - pBegin : -1);
+
+	if (IsAVX2Supported())
+	{
+		const unsigned char* pAVX2 = ScanAVX2(pattern, pBegin, pEnd);
+		CHECK(pAVX2 == pExpected, "%s: AVX2 %td, scalar %td", szCase, pAVX2 ? pAVX2 - pBegin : -1, pExpected ? pExpected - pBegin : -1);
+	}
+}
+
+static void TestFixedCases()
+{
+	// Small alphabet so anchors hit often and the full compare runs a lot
+	std::vector<unsigned char> memory(4096);
+	for (size_t i = 0; i < memory.size(); ++i)
+		memory[i] = (unsigned char)(i * 7 % 5);
+
+	const unsigned char* pBegin = memory.data();
+	const unsigned char* pEnd = pBegin + memory.size();
+
+	const short aobAtEnd[] = { 0x48, 0x8B, -1, 0x90, 0xC3 };
+	memcpy(memory.data() + memory.size() - 5, "\x48\x8B\x00\x90\xC3", 5);
+	CheckScanners(aobAtEnd, 5, pBegin, pEnd, "match at the very end");
+	CHECK(ScanScalar(PreparePattern(aobAtEnd, 5), pBegin, pEnd) == pEnd - 5, "scalar misses the match at the very end");
+
+	// One byte short of the match
+	CheckScanners(aobAtEnd, 5, pBegin, pEnd - 1, "range ends inside the match");
+	CHECK(ScanScalar(PreparePattern(aobAtEnd, 5), pBegin, pEnd - 1) == nullptr, "scalar matches past the end");
+
+	const short aobWildcards[] = { -1, -1, -1 };
+	CheckScanners(aobWildcards, 3, pBegin, pEnd, "wildcards only");
+	CheckScanners(aobWildcards, 3, pBegin, pBegin + 2, "wildcards only, range too short");
+
+	// Longer than a vector so the verification runs its SIMD part and the scalar tail
+	short aobLong[45];
+	for (size_t i = 0; i < 45; ++i)
+		aobLong[i] = i % 9 == 4 ? -1 : (short)(0x10 + i);
+
+	std::vector<unsigned char> longMatch(45);
+	for (size_t i = 0; i < 45; ++i)
+		longMatch[i] = (unsigned char)(0x10 + i);
+
+	memcpy(memory.data() + 1000, longMatch.data(), 45);
+	CheckScanners(aobLong, 45, pBegin, pEnd, "long pattern");
+	CHECK(ScanScalar(PreparePattern(aobLong, 45), pBegin, pEnd) == pBegin + 1000, "scalar misses the long pattern");
+
+	for (size_t i = 0; i < 64; ++i)
+		CheckScanners(aobLong, 45, pBegin + i, pBegin + 1000 + 45 + (i % 3), "long pattern, shifted range");
+}
+
+static void TestRandomCases()
+{
+	std::mt19937 rng(1234);
+	std::vector<unsigned char> memory(1 << 16);
+
+	for (int iteration = 0; iteration < 2000; ++iteration)
+	{
+		const int alphabet = 2 + (int)(rng() % 6);
+		for (auto& b : memory)
+			b = (unsigned char)(rng() % alphabet);
+
+		const size_t patternCount = 1 + rng() % 40;
+		std::vector<short> aobPattern(patternCount);
+		for (auto& s : aobPattern)
+			s = rng() % 4 == 0 ? -1 : (short)(rng() % alphabet);
+
+		// Plant a copy somewhere most of the time
+		if (rng() % 4 != 0)
+		{
+			size_t at = rng() % (memory.size() - patternCount + 1);
+			for (size_t i = 0; i < patternCount; ++i)
+			{
+				if (aobPattern[i] != -1)
+					memory[at + i] = (unsigned char)aobPattern[i];
+			}
+		}
+
+		// Unaligned ranges of every length class, the ends are exact so reads past them fail under ASan
+		const size_t begin = rng() % 64;
+		const size_t end = begin + rng() % (memory.size() - begin + 1);
+		std::vector<unsigned char> range(memory.begin() + begin, memory.begin() + end);
+
+		CheckScanners(aobPattern.data(), patternCount, range.data(), range.data() + range.size(), "random");
+	}
+}
+
+int main()
+{
+	std::printf("AVX2 %s\n", IsAVX2Supported() ? "supported" : "not supported, only SSE2 is checked");
+
+	TestFixedCases();
+	TestRandomCases();
+
+	return TestResult();
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdio>
+
+// Failed checks are printed and counted, main returns TestResult()
+inline int gFailedChecks = 0;
+
+#define CHECK(condition, ...) \
+	do \
+	{ \
+		if (!(condition)) \
+		{ \
+			++gFailedChecks; \
+			std::printf("%s:%d: CHECK(%s) failed: ", __FILE__, __LINE__, #condition); \
+			std::printf(__VA_ARGS__); \
+			std::printf("\n"); \
+		} \
+	} while (0)
+
+inline int TestResult()
+{
+	if (gFailedChecks != 0)
+	{
+		std::printf("%d check(s) failed\n", gFailedChecks);
+		return 1;
+	}
+
+	std::printf("All checks passed\n");
+	return 0;
+}
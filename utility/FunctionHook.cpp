@@ -60,6 +60,35 @@ bool FunctionHook::Create()
 	return true;
 }
 
+bool FunctionHook::Queue()
+{
+	if (pTarget == 0 || pDestination == 0 || pOriginal == 0)
+	{
+		LOG_WARNING("FunctionHook not initialized");
+		return false;
+	}
+
+	if (auto status = MH_QueueEnableHook((LPVOID)pTarget); status != MH_OK)
+	{
+		LOG_ERROR("Failed to queue hook " << std::hex << pTarget << ": " << MH_StatusToString(status));
+		return false;
+	}
+
+	LOG_INFO("Queued hook " << std::hex << pTarget << " -> " << pDestination);
+	return true;
+}
+
+bool FunctionHook::ApplyQueued()
+{
+	if (auto status = MH_ApplyQueued(); status != MH_OK)
+	{
+		LOG_ERROR("Failed to apply queued hooks: " << MH_StatusToString(status));
+		return false;
+	}
+
+	return true;
+}
+
 bool FunctionHook::Remove()
 {
 	// Don't try to remove invalid hooks.
@@ -17,6 +17,11 @@ public:
 
 	bool Create();
 
+	// Same as Create but the hook is only enabled by the next ApplyQueued,
+	// so several hooks can be enabled while the threads are frozen once.
+	bool Queue();
+	static bool ApplyQueued();
+
 	// Called automatically by the destructor, but you can call it explicitly
 	// if you need to remove the hook.
 	bool Remove();
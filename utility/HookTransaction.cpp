@@ -0,0 +1,94 @@
+#include <stdexcept>
+#include <Windows.h>
+#include "Log.hpp"
+#include "Profiler.hpp"
+#include "HookTransaction.hpp"
+
+HookTransaction::HookTransaction() : operations(), functionHooks()
+{
+}
+
+HookTransaction::~HookTransaction()
+{
+	if (Count() > 0)
+		LOG_WARNING("HookTransaction destroyed with " << Count() << " uncommitted hooks");
+}
+
+void HookTransaction::Add(std::function<bool()> fnApply)
+{
+	operations.push_back(std::move(fnApply));
+}
+
+void HookTransaction::AddPointerHook(std::unique_ptr<PointerHook>& pHook, void** pOld, void* pNew)
+{
+	operations.push_back([&pHook, pOld, pNew]()
+		{
+			pHook = std::make_unique<PointerHook>(pOld, pNew);
+			return true;
+		});
+}
+
+void HookTransaction::AddVtableHook(std::unique_ptr<VtableHook>& pHook, Address target, std::vector<std::pair<uint32_t, Address>> methods)
+{
+	operations.push_back([&pHook, target, methods = std::move(methods)]()
+		{
+			pHook = std::make_unique<VtableHook>(target);
+
+			for (const auto& [index, method] : methods)
+			{
+				if (!pHook->HookMethod(index, method))
+				{
+					LOG_ERROR("Failed to hook vtable method " << index << " of " << std::hex << target.Pointer());
+					return false;
+				}
+			}
+
+			return true;
+		});
+}
+
+void HookTransaction::AddFunctionHook(FunctionHook& hook)
+{
+	functionHooks.push_back(&hook);
+}
+
+bool HookTransaction::Commit()
+{
+	if (Count() == 0)
+		return true;
+
+	bool bSucceeded = true;
+	size_t count = Count();
+	int64_t iBegin = utility::Profiler::Now();
+
+	for (auto& fnApply : operations)
+	{
+		try
+		{
+			bSucceeded &= fnApply();
+		}
+		catch (const std::exception& e)
+		{
+			LOG_ERROR("Failed to apply hook: " << e.what());
+			bSucceeded = false;
+		}
+	}
+
+	// Queuing only marks the hooks, MinHook freezes the threads once to enable all of them
+	if (!functionHooks.empty())
+	{
+		for (auto pHook : functionHooks)
+			bSucceeded &= pHook->Queue();
+
+		bSucceeded &= FunctionHook::ApplyQueued();
+	}
+
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	LOG_INFO("Applied " << count << " hooks in " << (utility::Profiler::Now() - iBegin) * 1000.0 / frequency.QuadPart << " ms");
+
+	operations.clear();
+	functionHooks.clear();
+
+	return bSucceeded;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <utility>
+#include <functional>
+#include <Windows.h>
+#include "Address.hpp"
+#include "PointerHook.hpp"
+#include "VtableHook.hpp"
+#include "FunctionHook.hpp"
+
+// Queues pointer, vtable and function hooks and installs all of them on Commit, the game threads are
+// stopped at most once for the whole batch.
+// Pointer and vtable hooks only swap one pointer, the other threads see either the old or the new one,
+// so they are applied first without suspending anything. Function hooks patch code, MinHook enables all
+// of them in one freeze that also moves the threads out of the patched bytes. That freeze is the only
+// suspension, everything the operations allocate is allocated before it.
+// Nothing is touched until Commit(), queued operations must not suspend threads themselves.
+class HookTransaction
+{
+public:
+	HookTransaction();
+	virtual ~HookTransaction();
+
+	HookTransaction(const HookTransaction& other) = delete;
+	HookTransaction(HookTransaction&& other) = delete;
+	HookTransaction& operator=(const HookTransaction& other) = delete;
+	HookTransaction& operator=(HookTransaction&& other) = delete;
+
+	// Generic operation, returns false on failure
+	void Add(std::function<bool()> fnApply);
+
+	// The hook is created into pHook on commit
+	void AddPointerHook(std::unique_ptr<PointerHook>& pHook, void** pOld, void* pNew);
+	void AddVtableHook(std::unique_ptr<VtableHook>& pHook, Address target, std::vector<std::pair<uint32_t, Address>> methods);
+
+	// The hook must be created already, only enabling it is deferred
+	void AddFunctionHook(FunctionHook& hook);
+
+	// Applies everything in the order it was added, returns false if any of it failed
+	bool Commit();
+
+	size_t Count() const
+	{
+		return operations.size() + functionHooks.size();
+	}
+private:
+	std::vector<std::function<bool()>> operations;
+	std::vector<FunctionHook*> functionHooks;
+};
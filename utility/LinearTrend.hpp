@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cmath>
+
+namespace utility
+{
+	// Exponentially weighted least squares line through a stream of samples, O(1) per sample and no storage.
+	// Times are kept relative to the newest sample, every Add shifts the sums by the elapsed time then decays
+	// them, so a sample fTimeConstant seconds old weighs 1/e of the newest one.
+	class LinearTrend
+	{
+	public:
+		LinearTrend(float fTimeConstant) : fTimeConstant(fTimeConstant), fSpan(0.0f), sumW(0.0), sumT(0.0), sumV(0.0), sumTT(0.0), sumTV(0.0)
+		{
+		}
+
+		void Add(float fValue, float fDeltaTime)
+		{
+			if (sumW > 0.0)
+			{
+				// Move the origin to the new sample
+				const double dt = fDeltaTime;
+				sumTT -= 2.0 * dt * sumT - dt * dt * sumW;
+				sumTV -= dt * sumV;
+				sumT -= dt * sumW;
+
+				const double decay = std::exp(-dt / fTimeConstant);
+				sumW *= decay;
+				sumT *= decay;
+				sumV *= decay;
+				sumTT *= decay;
+				sumTV *= decay;
+
+				fSpan += fDeltaTime;
+			}
+
+			sumW += 1.0;
+			sumV += fValue;
+		}
+
+		void Clear()
+		{
+			fSpan = 0.0f;
+			sumW = sumT = sumV = sumTT = sumTV = 0.0;
+		}
+
+		// Seconds covered since the last Clear
+		float GetSpan() const
+		{
+			return fSpan;
+		}
+
+		// Value change per second, 0 until there are two samples at different times
+		float GetSlope() const
+		{
+			const double denominator = sumW * sumTT - sumT * sumT;
+			if (denominator <= 1e-9 * sumW * sumW)
+				return 0.0f;
+
+			return (float)((sumW * sumTV - sumT * sumV) / denominator);
+		}
+	private:
+		float fTimeConstant;
+		float fSpan;
+
+		// Weighted sums of 1, t, v, t^2 and t*v, t being negative seconds from the newest sample
+		double sumW;
+		double sumT;
+		double sumV;
+		double sumTT;
+		double sumTV;
+	};
+}
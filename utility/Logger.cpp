@@ -0,0 +1,251 @@
+#include <cstdio>
+#include <format>
+#include <functional>
+#include <iterator>
+#include "Logger.hpp"
+
+namespace utility
+{
+	Logger::Logger() : records(), enqueuePosition(0), droppedCount(0), dequeuePosition(0), fileMutex(), wsFilePath(), file(), iFileSize(0), buffer(), iStartTicks(0), iTicksFrequency(1), startTime(), pThreadFlush(nullptr)
+	{
+		for (size_t i = 0; i < QUEUE_SIZE; ++i)
+			records[i].sequence.store(i, std::memory_order_relaxed);
+
+		LARGE_INTEGER counter;
+		if (QueryPerformanceFrequency(&counter) && counter.QuadPart > 0)
+			iTicksFrequency = counter.QuadPart;
+
+		QueryPerformanceCounter(&counter);
+		iStartTicks = counter.QuadPart;
+
+		FILETIME systemTime, localTime;
+		GetSystemTimeAsFileTime(&systemTime);
+		FileTimeToLocalFileTime(&systemTime, &localTime);
+		startTime.LowPart = localTime.dwLowDateTime;
+		startTime.HighPart = localTime.dwHighDateTime;
+
+		buffer.reserve(64 * 1024);
+
+		pThreadFlush = std::make_unique<std::jthread>(std::bind_front(&Logger::Flush, this));
+	}
+
+	Logger::~Logger()
+	{
+		// Stops and joins the flush thread, which writes whatever is still queued
+		pThreadFlush.reset();
+	}
+
+	bool Logger::Open(const std::wstring& filePath)
+	{
+		std::scoped_lock _{ fileMutex };
+
+		if (file.is_open())
+			file.close();
+
+		wsFilePath = filePath;
+		Rotate();
+
+		return file.is_open();
+	}
+
+	void Logger::Flush(std::stop_token stopToken)
+	{
+		while (!stopToken.stop_requested())
+		{
+			if (!Drain())
+				std::this_thread::sleep_for(FLUSH_INTERVAL);
+		}
+
+		Drain();
+	}
+
+	bool Logger::Drain()
+	{
+		std::scoped_lock _{ fileMutex };
+
+#ifndef _DEBUG
+		// Nowhere to write yet, keep the messages queued until Open
+		if (!file.is_open())
+			return false;
+#endif
+
+		buffer.clear();
+
+		while (true)
+		{
+			RECORD& record = records[dequeuePosition & (QUEUE_SIZE - 1)];
+
+			// Empty, or the producer has not committed it yet
+			if (record.sequence.load(std::memory_order_acquire) != dequeuePosition + 1)
+				break;
+
+			Format(record, buffer);
+
+			record.sequence.store(dequeuePosition + QUEUE_SIZE, std::memory_order_release);
+			++dequeuePosition;
+		}
+
+		// Those were dropped after the records above got queued
+		if (size_t dropped = droppedCount.exchange(0, std::memory_order_relaxed))
+			std::format_to(std::back_inserter(buffer), "[W] Log queue full, dropped {} messages\n", dropped);
+
+		if (buffer.empty())
+			return false;
+
+#ifdef _DEBUG
+		fwrite(buffer.data(), 1, buffer.size(), stdout);
+		fflush(stdout);
+#endif
+
+		if (file.is_open())
+		{
+			if (iFileSize + buffer.size() > MAX_FILE_SIZE)
+				Rotate();
+
+			file.write(buffer.data(), buffer.size());
+			file.flush();
+			iFileSize += buffer.size();
+		}
+
+		return true;
+	}
+
+	void Logger::Format(const RECORD& record, std::string& line) const
+	{
+		static constexpr const char* LEVEL_PREFIXES[] = { "", "[I] ", "[W] ", "[E] " };
+
+		// 100ns units since the logger started, split to not overflow on long sessions
+		int64_t iTicks = record.iTicks - iStartTicks;
+		ULARGE_INTEGER time = startTime;
+		time.QuadPart += (iTicks / iTicksFrequency) * 10000000 + (iTicks % iTicksFrequency) * 10000000 / iTicksFrequency;
+
+		FILETIME fileTime{ time.LowPart, time.HighPart };
+		SYSTEMTIME sysTime{};
+		FileTimeToSystemTime(&fileTime, &sysTime);
+
+		std::format_to(std::back_inserter(line), "{:02}:{:02}:{:02}.{:03} {:>5} {}",
+			sysTime.wHour, sysTime.wMinute, sysTime.wSecond, sysTime.wMilliseconds, record.dwThreadId, LEVEL_PREFIXES[record.level & 0x3]);
+
+		const uint8_t* pData = record.data;
+		const uint8_t* pEnd = record.data + record.iSize;
+
+		while (pData < pEnd)
+		{
+			uint8_t type = *pData++;
+
+			switch (type & ~A_HEX)
+			{
+			case A_STRING:
+			case A_WSTRING:
+			{
+				uint16_t length;
+				memcpy(&length, pData, sizeof(uint16_t));
+				pData += sizeof(uint16_t);
+
+				if (type == A_STRING)
+				{
+					line.append((const char*)pData, length);
+					pData += length;
+					break;
+				}
+
+				// The chars are not aligned in the record
+				wchar_t wsText[sizeof(record.data) / sizeof(wchar_t)];
+				memcpy(wsText, pData, length * sizeof(wchar_t));
+				pData += length * sizeof(wchar_t);
+
+				int size = WideCharToMultiByte(CP_UTF8, 0, wsText, length, nullptr, 0, nullptr, nullptr);
+				if (size > 0)
+				{
+					size_t offset = line.size();
+					line.resize(offset + size);
+					WideCharToMultiByte(CP_UTF8, 0, wsText, length, line.data() + offset, size, nullptr, nullptr);
+				}
+				break;
+			}
+			case A_CHAR:
+				line.push_back((char)*pData++);
+				break;
+			case A_SIGNED:
+			{
+				int64_t value;
+				memcpy(&value, pData, sizeof(int64_t));
+				pData += sizeof(int64_t);
+				std::format_to(std::back_inserter(line), "{}", value);
+				break;
+			}
+			case A_UNSIGNED:
+			{
+				uint64_t value;
+				memcpy(&value, pData, sizeof(uint64_t));
+				pData += sizeof(uint64_t);
+
+				if (type & A_HEX)
+					std::format_to(std::back_inserter(line), "{:x}", value);
+				else
+					std::format_to(std::back_inserter(line), "{}", value);
+				break;
+			}
+			case A_FLOAT:
+			{
+				double value;
+				memcpy(&value, pData, sizeof(double));
+				pData += sizeof(double);
+				std::format_to(std::back_inserter(line), "{}", value);
+				break;
+			}
+			case A_POINTER:
+			{
+				uintptr_t value;
+				memcpy(&value, pData, sizeof(uintptr_t));
+				pData += sizeof(uintptr_t);
+				std::format_to(std::back_inserter(line), "{:#x}", value);
+				break;
+			}
+			default:
+				// Corrupted record, drop the rest of it
+				pData = pEnd;
+				break;
+			}
+		}
+
+		if (record.bIsTruncated)
+			line.append("...");
+
+		line.push_back('\n');
+	}
+
+	void Logger::Rotate()
+	{
+		if (wsFilePath.empty())
+			return;
+
+		if (file.is_open())
+			file.close();
+
+		// lop_bars.log -> lop_bars.1.log -> lop_bars.2.log, the oldest one is overwritten
+		WIN32_FILE_ATTRIBUTE_DATA attributes;
+		if (GetFileAttributesExW(wsFilePath.c_str(), GetFileExInfoStandard, &attributes) && (attributes.nFileSizeLow || attributes.nFileSizeHigh))
+		{
+			for (size_t i = MAX_FILE_COUNT - 1; i > 0; --i)
+				MoveFileExW(GetRotatedPath(i - 1).c_str(), GetRotatedPath(i).c_str(), MOVEFILE_REPLACE_EXISTING);
+		}
+
+		file.open(wsFilePath, std::ios::out | std::ios::binary | std::ios::trunc);
+		iFileSize = 0;
+	}
+
+	std::wstring Logger::GetRotatedPath(size_t index) const
+	{
+		if (index == 0)
+			return wsFilePath;
+
+		auto separator = wsFilePath.find_last_of(L"\\/");
+		auto extension = wsFilePath.find_last_of(L'.');
+
+		if (extension == std::wstring::npos || (separator != std::wstring::npos && extension < separator))
+			return wsFilePath + L"." + std::to_wstring(index);
+
+		return wsFilePath.substr(0, extension) + L"." + std::to_wstring(index) + wsFilePath.substr(extension);
+	}
+}
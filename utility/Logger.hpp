@@ -0,0 +1,309 @@
+#pragma once
+
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <fstream>
+#include <cstdint>
+#include <cstring>
+#include <concepts>
+#include <algorithm>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <ios>
+#include <Windows.h>
+#include "Address.hpp"
+
+namespace utility
+{
+	// Lock-free multi producer, single consumer log queue.
+	// Producers copy their raw arguments into a ring slot and never block or allocate, the text
+	// is only formatted by a background thread which appends it to a rotating log file.
+	// When the ring is full messages are dropped and counted instead of waiting.
+	class Logger
+	{
+	public:
+		enum LEVEL : uint8_t
+		{
+			L_NONE,
+			L_INFO,
+			L_WARNING,
+			L_ERROR
+		};
+
+		// Argument tags, the payload follows the tag in the record data
+		enum ARG_TYPE : uint8_t
+		{
+			A_STRING, // uint16_t length + chars
+			A_WSTRING, // uint16_t length + wchar_t
+			A_CHAR,
+			A_SIGNED, // int64_t
+			A_UNSIGNED, // uint64_t
+			A_FLOAT, // double
+			A_POINTER, // uintptr_t
+
+			A_HEX = 0x80
+		};
+
+		static constexpr size_t QUEUE_SIZE = 1024; // Power of two
+		static constexpr size_t MAX_FILE_SIZE = 1024 * 1024;
+		static constexpr size_t MAX_FILE_COUNT = 3; // Current file + rotated ones
+		static constexpr auto FLUSH_INTERVAL = std::chrono::milliseconds(10);
+
+		struct alignas(64) RECORD
+		{
+			std::atomic<size_t> sequence;
+			size_t iPosition;
+			int64_t iTicks;
+			DWORD dwThreadId;
+			LEVEL level;
+			bool bIsTruncated;
+			uint16_t iSize;
+			uint8_t data[224];
+		};
+
+		static Logger& GetInstance()
+		{
+			static Logger instance;
+			return instance;
+		}
+
+		Logger();
+		virtual ~Logger();
+
+		Logger(const Logger& other) = delete;
+		Logger(Logger&& other) = delete;
+		Logger& operator=(const Logger& other) = delete;
+		Logger& operator=(Logger&& other) = delete;
+
+		// Starts writing to filePath, the log of the previous session is rotated first.
+		// Messages logged before are kept in the queue and written once the file is open.
+		bool Open(const std::wstring& filePath);
+
+		// Producer side, returns nullptr when the queue is full
+		RECORD* Acquire(LEVEL level)
+		{
+			size_t position = enqueuePosition.load(std::memory_order_relaxed);
+
+			while (true)
+			{
+				RECORD& record = records[position & (QUEUE_SIZE - 1)];
+				intptr_t diff = (intptr_t)record.sequence.load(std::memory_order_acquire) - (intptr_t)position;
+
+				if (diff == 0)
+				{
+					if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+					{
+						LARGE_INTEGER counter;
+						QueryPerformanceCounter(&counter);
+
+						record.iPosition = position;
+						record.iTicks = counter.QuadPart;
+						record.dwThreadId = GetCurrentThreadId();
+						record.level = level;
+						record.bIsTruncated = false;
+						record.iSize = 0;
+						return &record;
+					}
+				}
+				else if (diff < 0)
+				{
+					droppedCount.fetch_add(1, std::memory_order_relaxed);
+					return nullptr;
+				}
+				else
+					position = enqueuePosition.load(std::memory_order_relaxed);
+			}
+		}
+
+		void Commit(RECORD* pRecord)
+		{
+			pRecord->sequence.store(pRecord->iPosition + 1, std::memory_order_release);
+		}
+	private:
+		void Flush(std::stop_token stopToken);
+		bool Drain();
+		void Format(const RECORD& record, std::string& line) const;
+		void Rotate();
+		std::wstring GetRotatedPath(size_t index) const;
+
+		std::array<RECORD, QUEUE_SIZE> records;
+		alignas(64) std::atomic<size_t> enqueuePosition;
+		alignas(64) std::atomic<size_t> droppedCount;
+		alignas(64) size_t dequeuePosition;
+
+		// Only touched by the flush thread and Open
+		std::mutex fileMutex;
+		std::wstring wsFilePath;
+		std::ofstream file;
+		size_t iFileSize;
+		std::string buffer;
+
+		// QPC ticks are converted to the local time relative to when the logger started
+		int64_t iStartTicks;
+		int64_t iTicksFrequency;
+		ULARGE_INTEGER startTime;
+
+		std::unique_ptr<std::jthread> pThreadFlush;
+	};
+
+	// Stream used by the LOG_* macros, only copies the arguments into the acquired record
+	class LogStream
+	{
+	public:
+		LogStream(Logger::LEVEL level) : pRecord(Logger::GetInstance().Acquire(level)), bIsHex(false)
+		{
+		}
+
+		~LogStream()
+		{
+			if (pRecord)
+				Logger::GetInstance().Commit(pRecord);
+		}
+
+		LogStream(const LogStream& other) = delete;
+		LogStream& operator=(const LogStream& other) = delete;
+
+		LogStream& operator<<(const char* value)
+		{
+			return value ? WriteString(Logger::A_STRING, value, strlen(value), sizeof(char)) : *this << "(null)";
+		}
+
+		LogStream& operator<<(std::string_view value)
+		{
+			return WriteString(Logger::A_STRING, value.data(), value.size(), sizeof(char));
+		}
+
+		LogStream& operator<<(const std::string& value)
+		{
+			return WriteString(Logger::A_STRING, value.data(), value.size(), sizeof(char));
+		}
+
+		LogStream& operator<<(const wchar_t* value)
+		{
+			return value ? WriteString(Logger::A_WSTRING, value, wcslen(value), sizeof(wchar_t)) : *this << "(null)";
+		}
+
+		LogStream& operator<<(std::wstring_view value)
+		{
+			return WriteString(Logger::A_WSTRING, value.data(), value.size(), sizeof(wchar_t));
+		}
+
+		LogStream& operator<<(const std::wstring& value)
+		{
+			return WriteString(Logger::A_WSTRING, value.data(), value.size(), sizeof(wchar_t));
+		}
+
+		// Only an actual char, a class converting to an integer must not end up written as a single character
+		template <typename T> requires std::is_same_v<T, char>
+		LogStream& operator<<(T value)
+		{
+			return WriteValue(Logger::A_CHAR, value);
+		}
+
+		template <std::integral T> requires (!std::is_same_v<T, char>)
+		LogStream& operator<<(T value)
+		{
+			// Same as iostream, hex integers are shown as unsigned values of their own width
+			if (bIsHex)
+				return WriteValue(Logger::A_UNSIGNED | Logger::A_HEX, (uint64_t)(std::make_unsigned_t<T>)value);
+
+			if constexpr (std::is_signed_v<T>)
+				return WriteValue(Logger::A_SIGNED, (int64_t)value);
+			else
+				return WriteValue(Logger::A_UNSIGNED, (uint64_t)value);
+		}
+
+		template <typename T> requires std::is_enum_v<T>
+		LogStream& operator<<(T value)
+		{
+			return *this << (std::underlying_type_t<T>)value;
+		}
+
+		template <std::floating_point T>
+		LogStream& operator<<(T value)
+		{
+			return WriteValue(Logger::A_FLOAT, (double)value);
+		}
+
+		template <typename T> requires (!std::is_same_v<std::remove_cv_t<T>, char> && !std::is_same_v<std::remove_cv_t<T>, wchar_t>)
+		LogStream& operator<<(T* value)
+		{
+			return WriteValue(Logger::A_POINTER, (uintptr_t)value);
+		}
+
+		LogStream& operator<<(const Address& value)
+		{
+			return WriteValue(Logger::A_POINTER, value.As<uintptr_t>());
+		}
+
+		// Only std::hex and std::dec are supported
+		LogStream& operator<<(std::ios_base& (*manipulator)(std::ios_base&))
+		{
+			if (manipulator == std::hex)
+				bIsHex = true;
+			else if (manipulator == std::dec)
+				bIsHex = false;
+
+			return *this;
+		}
+	private:
+		template <typename T>
+		LogStream& WriteValue(uint8_t type, T value)
+		{
+			if (!pRecord || pRecord->bIsTruncated)
+				return *this;
+
+			if (pRecord->iSize + 1 + sizeof(T) > sizeof(pRecord->data))
+			{
+				pRecord->bIsTruncated = true;
+				return *this;
+			}
+
+			pRecord->data[pRecord->iSize++] = type;
+			memcpy(pRecord->data + pRecord->iSize, &value, sizeof(T));
+			pRecord->iSize += sizeof(T);
+
+			return *this;
+		}
+
+		// Copies as many characters as the record can still hold
+		LogStream& WriteString(uint8_t type, const void* pChars, size_t length, size_t charSize)
+		{
+			constexpr size_t HEADER_SIZE = 1 + sizeof(uint16_t);
+
+			if (!pRecord || pRecord->bIsTruncated)
+				return *this;
+
+			size_t available = sizeof(pRecord->data) - pRecord->iSize;
+			if (available <= HEADER_SIZE)
+			{
+				pRecord->bIsTruncated = true;
+				return *this;
+			}
+
+			uint16_t count = (uint16_t)std::min(length, (available - HEADER_SIZE) / charSize);
+
+			pRecord->data[pRecord->iSize++] = type;
+			memcpy(pRecord->data + pRecord->iSize, &count, sizeof(uint16_t));
+			pRecord->iSize += sizeof(uint16_t);
+			memcpy(pRecord->data + pRecord->iSize, pChars, count * charSize);
+			pRecord->iSize += (uint16_t)(count * charSize);
+
+			pRecord->bIsTruncated = count < length;
+
+			return *this;
+		}
+
+		Logger::RECORD* pRecord;
+		bool bIsHex;
+	};
+
+	// Address converts to both uintptr_t and void*, it has to get its own overload and be shown as a pointer
+	static_assert(std::is_same_v<decltype(std::declval<LogStream&>() << std::declval<const Address&>()), LogStream&>);
+}
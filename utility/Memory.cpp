@@ -1,10 +1,30 @@
+#define NOMINMAX
+
 #include "Memory.hpp"
+#include "Module.hpp"
+#include "RegionMap.hpp"
+#include "ScanKernels.hpp"
 #include <vector>
+#include <thread>
+#include <atomic>
 #include <Windows.h>
 
 namespace utility
 {
-	inline bool CompareByteArray(const short* aobPattern, const char* aobMemory, size_t size)
+	static bool IsReadableProtection(DWORD dwProtect)
+	{
+		if (dwProtect & (PAGE_GUARD | PAGE_NOACCESS))
+			return false;
+
+		constexpr DWORD dwMask = (
+			PAGE_READONLY | PAGE_READWRITE | PAGE_WRITECOPY |
+			PAGE_EXECUTE_READ | PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY
+			);
+
+		return (dwProtect & dwMask) != 0;
+	}
+
+	bool CompareByteArray(const short* aobPattern, const char* aobMemory, size_t size)
 	{
 		for (auto i = 0; i < size; ++i)
 		{
@@ -16,62 +36,158 @@ namespace utility
 		return true;
 	}
 
-	char* PatternScan(const short* aobPattern, size_t patternSize, void* pStartAddress, size_t memorySize)
+	void ForEachReadableRun(void* pStartAddress, size_t memorySize, const std::function<bool(char* pBegin, char* pEnd)>& callback)
 	{
-		size_t patternCount = patternSize / sizeof(short);
-		char* pFinalBlock = (char*)pStartAddress + memorySize - patternCount;
+		auto pStart = (char*)pStartAddress;
+		auto pEnd = pStart + memorySize;
+		auto pRunBegin = pStart;
+		auto pRunEnd = pStart;
 
-		for (auto i = (char*)pStartAddress; i <= pFinalBlock; ++i)
+		// Walk the range one region at a time and report each run of adjacent readable regions
+		// as a whole, so matches that straddle a region boundary are still found.
+		MEMORY_BASIC_INFORMATION mbi;
+		for (auto p = pStart; p < pEnd; )
 		{
-			if (::IsBadReadPtr(i, patternCount) != 0)
+			if (!::VirtualQuery(p, &mbi, sizeof(MEMORY_BASIC_INFORMATION)))
+				break;
+
+			auto pRegionEnd = (char*)mbi.BaseAddress + mbi.RegionSize;
+			if (pRegionEnd > pEnd)
+				pRegionEnd = pEnd;
+
+			if (mbi.State == MEM_COMMIT && IsReadableProtection(mbi.Protect))
 			{
-				i += patternCount - 1;
-				continue;
+				if (pRunEnd != p)
+					pRunBegin = p;
+				pRunEnd = pRegionEnd;
 			}
-
-			if (CompareByteArray(aobPattern, i, patternCount))
+			else if (pRunBegin != pRunEnd)
 			{
-				return i;
+				if (!callback(pRunBegin, pRunEnd))
+					return;
+				pRunBegin = pRunEnd = p;
 			}
+
+			p = pRegionEnd;
 		}
 
-		return nullptr;
+		if (pRunBegin != pRunEnd)
+			callback(pRunBegin, pRunEnd);
 	}
 
-	bool IsBadReadPtr(void* ptr)
+	void ParallelForEachChunk(void* pStartAddress, size_t memorySize, size_t overlap, const std::function<bool(char* pBegin, char* pEnd)>& callback)
 	{
-		MEMORY_BASIC_INFORMATION mbi;
+		// Small enough chunks for the workers to balance and stop early, big enough to amortize the hand out
+		constexpr size_t MIN_CHUNK_SIZE = 1024 * 1024;
+		constexpr size_t CHUNKS_PER_WORKER = 4;
 
-		if (!::VirtualQuery(ptr, &mbi, sizeof(MEMORY_BASIC_INFORMATION)))
-			return true;
+		std::vector<std::pair<char*, char*>> runs;
+		size_t readableSize = 0;
 
-		if (mbi.Protect & (PAGE_GUARD | PAGE_NOACCESS))
-			return true;
+		ForEachReadableRun(pStartAddress, memorySize, [&](char* pBegin, char* pEnd)
+			{
+				runs.emplace_back(pBegin, pEnd);
+				readableSize += pEnd - pBegin;
+				return true;
+			});
 
-		constexpr DWORD dwMask = (
-			PAGE_READONLY | PAGE_READWRITE | PAGE_WRITECOPY |
-			PAGE_EXECUTE_READ | PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY
-			);
+		const size_t workerCount = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+		const size_t chunkSize = std::max(readableSize / (workerCount * CHUNKS_PER_WORKER), MIN_CHUNK_SIZE);
 
-		return !(mbi.Protect & dwMask);
+		std::vector<std::pair<char*, char*>> chunks;
+		for (auto& run : runs)
+		{
+			for (auto p = run.first; p < run.second; p += chunkSize)
+			{
+				auto pChunkEnd = (size_t)(run.second - p) > chunkSize + overlap ? p + chunkSize + overlap : run.second;
+				chunks.emplace_back(p, pChunkEnd);
+
+				if (pChunkEnd == run.second)
+					break;
+			}
+		}
+
+		if (chunks.size() <= 1 || workerCount == 1)
+		{
+			for (auto& chunk : chunks)
+			{
+				if (!callback(chunk.first, chunk.second))
+					break;
+			}
+			return;
+		}
+
+		std::atomic<size_t> nextChunk = 0;
+		std::atomic<bool> bStop = false;
+
+		auto fnWorker = [&]()
+			{
+				// A chunk that was handed out is always scanned, it may hold a lower match than the one that stopped us
+				while (!bStop)
+				{
+					size_t i = nextChunk++;
+					if (i >= chunks.size())
+						break;
+
+					if (!callback(chunks[i].first, chunks[i].second))
+						bStop = true;
+				}
+			};
+
+		{
+			std::vector<std::jthread> workers;
+			for (size_t i = 1; i < std::min(workerCount, chunks.size()); ++i)
+				workers.emplace_back(fnWorker);
+
+			fnWorker();
+		}
 	}
 
-	inline uintptr_t* GoodPtrOrNull(void* ptr)
+	char* PatternScan(const short* aobPattern, size_t patternSize, void* pStartAddress, size_t memorySize)
 	{
-		MEMORY_BASIC_INFORMATION mbi;
+		size_t patternCount = patternSize / sizeof(short);
 
-		if (!::VirtualQuery(ptr, &mbi, sizeof(MEMORY_BASIC_INFORMATION)))
+		if (patternCount == 0 || memorySize < patternCount)
 			return nullptr;
 
-		if (mbi.Protect & (PAGE_GUARD | PAGE_NOACCESS))
+		const SCAN_PATTERN pattern = PreparePattern(aobPattern, patternCount);
+		const ScanFunction fnScan = GetScanFunction();
+		std::atomic<char*> pMatch = nullptr;
+
+		ParallelForEachChunk(pStartAddress, memorySize, patternCount - 1, [&](char* pBegin, char* pEnd)
+			{
+				auto pChunkMatch = (char*)fnScan(pattern, (const unsigned char*)pBegin, (const unsigned char*)pEnd);
+				if (pChunkMatch == nullptr)
+					return true;
+
+				// Keep the lowest match, chunks below this one may still be running
+				char* pCurrent = pMatch;
+				while ((pCurrent == nullptr || pChunkMatch < pCurrent) && !pMatch.compare_exchange_weak(pCurrent, pChunkMatch));
+
+				return false;
+			});
+
+		return pMatch;
+	}
+
+	char* PatternScan(const short* aobPattern, size_t patternSize, HMODULE module, std::string_view section)
+	{
+		auto range = GetModuleSection(module, section);
+
+		if (!range)
 			return nullptr;
 
-		constexpr DWORD dwMask = (
-			PAGE_READONLY | PAGE_READWRITE | PAGE_WRITECOPY |
-			PAGE_EXECUTE_READ | PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY
-			);
+		return PatternScan(aobPattern, patternSize, (void*)range->first, range->second);
+	}
+
+	bool IsBadReadPtr(void* ptr)
+	{
+		return !RegionMap::GetInstance().IsReadable(ptr);
+	}
 
-		if (!(mbi.Protect & dwMask))
+	inline uintptr_t* GoodPtrOrNull(void* ptr)
+	{
+		if (!RegionMap::GetInstance().IsReadable(ptr))
 			return nullptr;
 
 		return (uintptr_t*)ptr;
@@ -1,11 +1,24 @@
 #pragma once
 
+#include <cstdint>
 #include <vector>
+#include <functional>
+#include <string_view>
+#include <Windows.h>
 
 namespace utility
 {
 	bool CompareByteArray(const short* aobPattern, const char* aobMemory, size_t size);
 	char* PatternScan(const short* aobPattern, size_t patternSize, void* pStartAddress, size_t memorySize);
+	// Scans only the named section of a loaded module, e.g. ".text" for code or ".rdata" for vtables and strings.
+	char* PatternScan(const short* aobPattern, size_t patternSize, HMODULE module, std::string_view section);
+	// Calls callback for each run of adjacent committed and readable regions inside the range,
+	// stops early when callback returns false.
+	void ForEachReadableRun(void* pStartAddress, size_t memorySize, const std::function<bool(char* pBegin, char* pEnd)>& callback);
+	// Splits the readable runs of the range into chunks that overlap the next one by overlap bytes and
+	// hands them out in address order to hardware_concurrency() workers. Once callback returns false no
+	// further chunks are handed out, every chunk below it has already been started and runs to completion.
+	void ParallelForEachChunk(void* pStartAddress, size_t memorySize, size_t overlap, const std::function<bool(char* pBegin, char* pEnd)>& callback);
 	bool IsBadReadPtr(void* ptr);
 	uintptr_t* GoodPtrOrNull(void* ptr);
 	void* ReadMultiLvlPtr(void* ptr, const std::vector<size_t>& offsetList);
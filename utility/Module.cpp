@@ -5,13 +5,13 @@
 #include <fstream>
 #include <filesystem>
 #include <unordered_set>
+#include <unordered_map>
 #include <mutex>
 #include <shlwapi.h>
 #include <windows.h>
 #include <winternl.h>
 #include "Log.hpp"
 #include "String.hpp"
-#include "Thread.hpp"
 #include "Module.hpp"
 
 #pragma comment(lib, "Shlwapi.lib")
@@ -190,6 +190,97 @@ namespace utility
 		return data;
 	}
 
+	static std::mutex gImageCacheMutex{};
+	static std::unordered_map<std::wstring, std::span<const uint8_t>> gImageCache{};
+
+	static bool IsValidImage(std::span<const uint8_t> image)
+	{
+		if (image.size() < sizeof(IMAGE_DOS_HEADER))
+		{
+			return false;
+		}
+
+		auto dosHeader = (PIMAGE_DOS_HEADER)image.data();
+
+		if (dosHeader->e_magic != IMAGE_DOS_SIGNATURE || dosHeader->e_lfanew < 0 || (size_t)dosHeader->e_lfanew + sizeof(IMAGE_NT_HEADERS) > image.size())
+		{
+			return false;
+		}
+
+		auto ntHeaders = (PIMAGE_NT_HEADERS)(image.data() + dosHeader->e_lfanew);
+
+		if (ntHeaders->Signature != IMAGE_NT_SIGNATURE)
+		{
+			return false;
+		}
+
+		// PtrFromRVA walks the section table without checking it
+		auto sectionTable = (uintptr_t)IMAGE_FIRST_SECTION(ntHeaders) - (uintptr_t)image.data();
+
+		return sectionTable + ntHeaders->FileHeader.NumberOfSections * sizeof(IMAGE_SECTION_HEADER) <= image.size();
+	}
+
+	std::optional<std::span<const uint8_t>> MapModuleFromDisk(HMODULE module)
+	{
+		auto path = GetModulePathW(module);
+
+		if (!path)
+		{
+			return {};
+		}
+
+		std::scoped_lock _{ gImageCacheMutex };
+
+		if (auto it = gImageCache.find(*path); it != gImageCache.end())
+		{
+			return it->second;
+		}
+
+		auto hFile = CreateFileW(path->c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+		if (hFile == INVALID_HANDLE_VALUE)
+		{
+			return {};
+		}
+
+		LARGE_INTEGER fileSize{};
+		HANDLE hMapping = nullptr;
+
+		if (GetFileSizeEx(hFile, &fileSize) && fileSize.QuadPart > 0)
+		{
+			hMapping = CreateFileMappingW(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		}
+
+		CloseHandle(hFile);
+
+		if (hMapping == nullptr)
+		{
+			return {};
+		}
+
+		// The view keeps the mapping alive on its own
+		auto pView = (const uint8_t*)MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+		CloseHandle(hMapping);
+
+		if (pView == nullptr)
+		{
+			return {};
+		}
+
+		auto image = std::span<const uint8_t>{ pView, (size_t)fileSize.QuadPart };
+
+		if (!IsValidImage(image))
+		{
+			LOG_WARNING("Invalid PE headers in " << *path);
+			UnmapViewOfFile(pView);
+			return {};
+		}
+
+		gImageCache.emplace(*path, image);
+
+		return image;
+	}
+
 	std::optional<std::vector<uint8_t>> GetOriginalBytes(Address address)
 	{
 		auto moduleWithin = GetModuleWithin(address);
@@ -204,9 +295,9 @@ namespace utility
 
 	std::optional<std::vector<uint8_t>> GetOriginalBytes(HMODULE module, Address address)
 	{
-		auto disk_data = ReadModuleFromDisk(module);
+		auto image = MapModuleFromDisk(module);
 
-		if (disk_data.empty())
+		if (!image)
 		{
 			return std::nullopt;
 		}
@@ -221,9 +312,9 @@ namespace utility
 		auto moduleRVA = address.As<uintptr_t>() - *moduleBase;
 
 		// obtain the file offset of the address now
-		auto pDisk = PtrFromRVA(disk_data.data(), moduleRVA);
+		auto pDisk = PtrFromRVA((uint8_t*)image->data(), moduleRVA);
 
-		if (!pDisk)
+		if (!pDisk || *pDisk < (uintptr_t)image->data() || *pDisk >= (uintptr_t)image->data() + image->size())
 		{
 			return std::nullopt;
 		}
@@ -231,18 +322,21 @@ namespace utility
 		auto aobOriginal = std::vector<uint8_t>{};
 
 		auto aobModule = address.As<uint8_t*>();
-		auto aobDisk = (uint8_t*)*pDisk;
+		auto aobDisk = (const uint8_t*)*pDisk;
+
+		// never read past the end of the mapped file
+		const size_t available = (uintptr_t)image->data() + image->size() - *pDisk;
 
 		// copy the bytes from the disk data to the original bytes
 		// copy only until the bytes start to match eachother
-		for (auto i = 0; ; ++i)
+		for (size_t i = 0; i < available; ++i)
 		{
 			if (aobModule[i] == aobDisk[i])
 			{
 				bool actually_matches = true;
 
 				// Lookahead 4 bytes to check if any other part is different before breaking out.
-				for (auto j = 1; j <= 4; ++j)
+				for (size_t j = 1; j <= 4 && i + j < available; ++j)
 				{
 					if (aobModule[i + j] != aobDisk[i + j])
 					{
@@ -299,19 +393,6 @@ namespace utility
 		return module;
 	}
 
-	HMODULE SafeUnlink(HMODULE module)
-	{
-		if (module == nullptr)
-		{
-			return nullptr;
-		}
-
-		ThreadSuspender _{};
-
-		Unlink(module);
-		return module;
-	}
-
 	HMODULE FindPartialModule(std::wstring_view name)
 	{
 		HMODULE module = nullptr;
@@ -390,30 +471,80 @@ namespace utility
 	}
 
 	std::optional<uintptr_t> PtrFromRVA(uint8_t* dll, uintptr_t rva)
+	{
+		std::optional<uintptr_t> ptr{};
+
+		// Go through each section searching for where the rva lands.
+		ForEachSection(dll, [&](PIMAGE_SECTION_HEADER section)
+			{
+				auto size = section->Misc.VirtualSize;
+
+				if (size == 0)
+				{
+					size = section->SizeOfRawData;
+				}
+
+				if (rva >= section->VirtualAddress && rva < ((uintptr_t)section->VirtualAddress + size))
+				{
+					auto delta = section->VirtualAddress - section->PointerToRawData;
+
+					ptr = (uintptr_t)(dll + (rva - delta));
+					return false;
+				}
+
+				return true;
+			});
+
+		return ptr;
+	}
+
+	void ForEachSection(uint8_t* dll, std::function<bool(PIMAGE_SECTION_HEADER)> callback)
 	{
 		// Get the first section.
 		auto dosHeader = (PIMAGE_DOS_HEADER)&dll[0];
 		auto ntHeaders = (PIMAGE_NT_HEADERS)&dll[dosHeader->e_lfanew];
 		auto section = IMAGE_FIRST_SECTION(ntHeaders);
 
-		// Go through each section searching for where the rva lands.
 		for (uint16_t i = 0; i < ntHeaders->FileHeader.NumberOfSections; ++i, ++section)
 		{
-			auto size = section->Misc.VirtualSize;
-
-			if (size == 0)
+			if (!callback(section))
 			{
-				size = section->SizeOfRawData;
+				break;
 			}
+		}
+	}
+
+	std::optional<std::pair<uintptr_t, size_t>> GetModuleSection(HMODULE module, std::string_view name)
+	{
+		// GetModuleSize validates the dos and nt headers for us.
+		if (!GetModuleSize(module))
+		{
+			return {};
+		}
+
+		std::optional<std::pair<uintptr_t, size_t>> range{};
 
-			if (rva >= section->VirtualAddress && rva < ((uintptr_t)section->VirtualAddress + size))
+		ForEachSection((uint8_t*)module, [&](PIMAGE_SECTION_HEADER section)
 			{
-				auto delta = section->VirtualAddress - section->PointerToRawData;
+				// Section names are padded with zeros but not terminated when they are 8 chars long.
+				auto sectionName = std::string_view{ (const char*)section->Name, strnlen((const char*)section->Name, IMAGE_SIZEOF_SHORT_NAME) };
 
-				return (uintptr_t)(dll + (rva - delta));
-			}
-		}
+				if (sectionName != name)
+				{
+					return true;
+				}
 
-		return {};
+				auto size = section->Misc.VirtualSize;
+
+				if (size == 0)
+				{
+					size = section->SizeOfRawData;
+				}
+
+				range = std::make_pair((uintptr_t)module + section->VirtualAddress, (size_t)size);
+				return false;
+			});
+
+		return range;
 	}
 }
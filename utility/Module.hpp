@@ -6,6 +6,7 @@
 #include <optional>
 #include <string>
 #include <vector>
+#include <span>
 #include <string_view>
 #include <functional>
 #include <Windows.h>
@@ -35,6 +36,10 @@ namespace utility
 
 	std::vector<uint8_t> ReadModuleFromDisk(HMODULE module);
 
+	// Maps the file of the module read-only, only the pages that get touched are read from disk.
+	// The view is cached per path and stays mapped until the process exits.
+	std::optional<std::span<const uint8_t>> MapModuleFromDisk(HMODULE module);
+
 	// Returns the original bytes of the module at the given address.
 	// useful for un-patching something.
 	std::optional<std::vector<uint8_t>> GetOriginalBytes(Address address);
@@ -44,9 +49,15 @@ namespace utility
 	// done so before calling it.
 	std::optional<uintptr_t> PtrFromRVA(uint8_t* dll, uintptr_t rva);
 
+	// Walks the section table, stops early when callback returns false.
+	// Note: This function doesn't validate the dll's headers either.
+	void ForEachSection(uint8_t* dll, std::function<bool(PIMAGE_SECTION_HEADER)> callback);
+
+	// Returns the address range of the named section (e.g. ".text", ".rdata") of a loaded module.
+	std::optional<std::pair<uintptr_t, size_t>> GetModuleSection(HMODULE module, std::string_view name);
+
 	HMODULE GetExecutable();
 	HMODULE Unlink(HMODULE module);
-	HMODULE SafeUnlink(HMODULE module);
 	HMODULE FindPartialModule(std::wstring_view name);
 
 	void ForEachModule(std::function<void(LIST_ENTRY*, _LDR_DATA_TABLE_ENTRY*)> callback);
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+
+namespace utility
+{
+	// Bounded lock-free queue for any number of producer threads and a single consumer thread.
+	// TryPush never blocks, it fails when the queue is full so a hooked game function never waits on us.
+	template <typename T, size_t N>
+	class MpscQueue
+	{
+	public:
+		static_assert(N > 0 && (N & (N - 1)) == 0, "MpscQueue size must be a power of two");
+		static_assert(std::is_trivially_copyable_v<T>, "MpscQueue can only hold trivially copyable types");
+
+		MpscQueue() : slots(), enqueuePosition(0), dequeuePosition(0)
+		{
+			for (size_t i = 0; i < N; ++i)
+				slots[i].sequence.store(i, std::memory_order_relaxed);
+		}
+
+		MpscQueue(const MpscQueue& other) = delete;
+		MpscQueue& operator=(const MpscQueue& other) = delete;
+
+		// Producer side, any thread
+		bool TryPush(const T& value)
+		{
+			size_t position = enqueuePosition.load(std::memory_order_relaxed);
+
+			while (true)
+			{
+				SLOT& slot = slots[position & (N - 1)];
+				intptr_t diff = (intptr_t)slot.sequence.load(std::memory_order_acquire) - (intptr_t)position;
+
+				if (diff == 0)
+				{
+					if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+					{
+						slot.value = value;
+						slot.sequence.store(position + 1, std::memory_order_release);
+						return true;
+					}
+				}
+				else if (diff < 0)
+					return false;
+				else
+					position = enqueuePosition.load(std::memory_order_relaxed);
+			}
+		}
+
+		// Consumer side, only one thread
+		bool TryPop(T& value)
+		{
+			SLOT& slot = slots[dequeuePosition & (N - 1)];
+
+			if (slot.sequence.load(std::memory_order_acquire) != dequeuePosition + 1)
+				return false;
+
+			value = slot.value;
+			slot.sequence.store(dequeuePosition + N, std::memory_order_release);
+			++dequeuePosition;
+
+			return true;
+		}
+
+		bool IsEmpty() const
+		{
+			return slots[dequeuePosition & (N - 1)].sequence.load(std::memory_order_acquire) != dequeuePosition + 1;
+		}
+	private:
+		struct SLOT
+		{
+			std::atomic<size_t> sequence;
+			T value;
+		};
+
+		std::array<SLOT, N> slots;
+		alignas(64) std::atomic<size_t> enqueuePosition;
+		alignas(64) size_t dequeuePosition;
+	};
+}
@@ -0,0 +1,165 @@
+#include <fstream>
+#include <cstdio>
+#include "Profiler.hpp"
+
+namespace utility
+{
+	Profiler::Profiler() : mutex(), zones(), zoneCount(0), ticksPerMicrosecond(1.0)
+	{
+		LARGE_INTEGER frequency;
+		if (QueryPerformanceFrequency(&frequency) && frequency.QuadPart > 0)
+			ticksPerMicrosecond = frequency.QuadPart / 1000000.0;
+	}
+
+	Profiler::~Profiler()
+	{
+	}
+
+	size_t Profiler::AddZone(std::string_view name)
+	{
+		std::scoped_lock _{ mutex };
+
+		const size_t count = zoneCount.load(std::memory_order_relaxed);
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			if (zones[i]->name == name)
+				return i;
+		}
+
+		if (count == MAX_ZONES)
+			return (size_t)-1;
+
+		zones[count] = std::make_unique<ZONE>();
+		zones[count]->name = name;
+		zones[count]->next = 0;
+
+		// Published once complete, Record never sees a zone being built
+		zoneCount.store(count + 1, std::memory_order_release);
+
+		return count;
+	}
+
+	void Profiler::Record(size_t zone, int64_t iBegin, int64_t iEnd)
+	{
+		if (zone >= zoneCount.load(std::memory_order_acquire))
+			return;
+
+		auto& z = *zones[zone];
+		const uint64_t sequence = z.sequence.load(std::memory_order_relaxed);
+
+		z.sequence.store(sequence + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		z.timings.Add((float)((iEnd - iBegin) / ticksPerMicrosecond / 1000.0));
+		z.events[z.next] = { iBegin, iEnd, GetCurrentThreadId() };
+		z.next = (z.next + 1) % TIMING_SAMPLES;
+
+		z.sequence.store(sequence + 2, std::memory_order_release);
+	}
+
+	void Profiler::ForEachZone(const std::function<void(const ZONE& zone)>& callback)
+	{
+		const size_t count = zoneCount.load(std::memory_order_acquire);
+
+		for (size_t i = 0; i < count; ++i)
+			callback(*zones[i]);
+	}
+
+	bool Profiler::ExportChromeTrace(const std::wstring& filePath)
+	{
+		struct ZONE_EVENTS
+		{
+			const std::string* pName;
+			std::array<ZONE::EVENT, TIMING_SAMPLES> events;
+			size_t count;
+		};
+
+		// Copy everything before touching the file, retry a zone when it was recorded during its copy
+		const size_t zoneTotal = zoneCount.load(std::memory_order_acquire);
+		std::vector<ZONE_EVENTS> copies(zoneTotal);
+
+		for (size_t i = 0; i < zoneTotal; ++i)
+		{
+			auto& zone = *zones[i];
+			auto& copy = copies[i];
+			copy.pName = &zone.name;
+
+			uint64_t sequence;
+			do
+			{
+				sequence = zone.sequence.load(std::memory_order_acquire);
+				if (sequence & 1)
+					continue;
+
+				copy.count = zone.timings.Count();
+
+				// Oldest event first
+				for (size_t j = 0; j < copy.count; ++j)
+					copy.events[j] = zone.events[(zone.next + TIMING_SAMPLES - copy.count + j) % TIMING_SAMPLES];
+
+				std::atomic_thread_fence(std::memory_order_acquire);
+			} while ((sequence & 1) || zone.sequence.load(std::memory_order_relaxed) != sequence);
+		}
+
+		std::ofstream file(filePath, std::ios::out | std::ios::trunc);
+		if (!file)
+			return false;
+
+		const DWORD dwProcessId = GetCurrentProcessId();
+		bool bIsFirst = true;
+
+		file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+		for (auto& copy : copies)
+		{
+			for (size_t i = 0; i < copy.count; ++i)
+			{
+				auto& event = copy.events[i];
+
+				file << (bIsFirst ? "" : ",") << std::fixed << "{\"name\":";
+				WriteJsonString(file, *copy.pName);
+				file << ",\"ph\":\"X\""
+					<< ",\"ts\":" << event.iBegin / ticksPerMicrosecond
+					<< ",\"dur\":" << (event.iEnd - event.iBegin) / ticksPerMicrosecond
+					<< ",\"pid\":" << dwProcessId << ",\"tid\":" << event.dwThreadId << "}";
+
+				bIsFirst = false;
+			}
+		}
+
+		file << "]}" << std::endl;
+
+		return (bool)file;
+	}
+
+	void Profiler::WriteJsonString(std::ostream& stream, std::string_view text)
+	{
+		stream << '"';
+
+		for (char c : text)
+		{
+			switch (c)
+			{
+				case '"': stream << "\\\""; break;
+				case '\\': stream << "\\\\"; break;
+				case '\n': stream << "\\n"; break;
+				case '\r': stream << "\\r"; break;
+				case '\t': stream << "\\t"; break;
+				default:
+					if ((unsigned char)c < 0x20)
+					{
+						char szEscape[8];
+						snprintf(szEscape, sizeof(szEscape), "\\u%04x", (unsigned char)c);
+						stream << szEscape;
+					}
+					else
+					{
+						stream << c;
+					}
+			}
+		}
+
+		stream << '"';
+	}
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <ostream>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <Windows.h>
+#include "RollingStats.hpp"
+
+namespace utility
+{
+	// Collects the CPU duration of named zones, timed with QueryPerformanceCounter.
+	// Each zone keeps its last TIMING_SAMPLES durations for the overlay graph and
+	// the matching begin/end ticks for the Chrome trace export.
+	// Recording never locks: a zone is written by one thread at a time and guarded by a sequence
+	// counter, other threads copy it and retry when a write happened during the copy.
+	class Profiler
+	{
+	public:
+		static constexpr size_t TIMING_SAMPLES = 512;
+		static constexpr size_t MAX_ZONES = 64;
+
+		typedef RollingStats<TIMING_SAMPLES> TIMINGS;
+
+		struct ZONE
+		{
+			std::string name;
+			TIMINGS timings; // Milliseconds
+
+			// Ring of the last recorded events, next is the oldest one
+			struct EVENT
+			{
+				int64_t iBegin;
+				int64_t iEnd;
+				DWORD dwThreadId;
+			};
+			std::array<EVENT, TIMING_SAMPLES> events;
+			size_t next;
+
+			std::atomic<uint64_t> sequence; // Odd while a record is being written
+		};
+
+		static Profiler& GetInstance()
+		{
+			static Profiler instance;
+			return instance;
+		}
+
+		Profiler();
+		virtual ~Profiler();
+
+		Profiler(const Profiler& other) = delete;
+		Profiler(Profiler&& other) = delete;
+		Profiler& operator=(const Profiler& other) = delete;
+		Profiler& operator=(Profiler&& other) = delete;
+
+		// Returns the id of the zone, the same name always gets the same id. -1 once MAX_ZONES are used.
+		size_t AddZone(std::string_view name);
+		void Record(size_t zone, int64_t iBegin, int64_t iEnd);
+
+		// Call from the thread recording the zones, the timings are read as they are being written otherwise
+		void ForEachZone(const std::function<void(const ZONE& zone)>& callback);
+
+		// Writes every recorded event in the Chrome trace event format (chrome://tracing, Perfetto).
+		// The events are copied first, recording goes on while the file is written.
+		bool ExportChromeTrace(const std::wstring& filePath);
+
+		static int64_t Now()
+		{
+			LARGE_INTEGER counter;
+			QueryPerformanceCounter(&counter);
+			return counter.QuadPart;
+		}
+	private:
+		std::mutex mutex; // Only taken to add zones
+		std::array<std::unique_ptr<ZONE>, MAX_ZONES> zones;
+		std::atomic<size_t> zoneCount;
+		double ticksPerMicrosecond;
+
+		static void WriteJsonString(std::ostream& stream, std::string_view text);
+	};
+
+	// Records the time between its construction and destruction into a profiler zone
+	class ScopedTimer
+	{
+	public:
+		ScopedTimer(size_t zone) : zone(zone), iBegin(Profiler::Now())
+		{
+		}
+
+		~ScopedTimer()
+		{
+			Profiler::GetInstance().Record(zone, iBegin, Profiler::Now());
+		}
+
+		ScopedTimer(const ScopedTimer& other) = delete;
+		ScopedTimer& operator=(const ScopedTimer& other) = delete;
+	private:
+		size_t zone;
+		int64_t iBegin;
+	};
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <type_traits>
+#include "RegionMap.hpp"
+
+namespace utility
+{
+	// Compile time version of ReadMultiLvlPtr, unrolled into one validated load per hop.
+	// Every offset but the last is added and dereferenced, the last one is only added:
+	// PtrChain<0x848, 0xE0, 0x28>::Read<LIST_DATA>(p) reads *(LIST_DATA*)(*(uintptr_t*)(*(uintptr_t*)(p + 0x848) + 0xE0) + 0x28)
+	template <size_t... Offsets>
+	class PtrChain
+	{
+	public:
+		static_assert(sizeof...(Offsets) > 0, "PtrChain needs at least one offset");
+
+		// Returns the final address, or nullopt when a pointer on the way is unreadable or null
+		static std::optional<uintptr_t> Resolve(const void* pBase)
+		{
+			uintptr_t address = (uintptr_t)pBase;
+
+			if (address == 0 || !Follow(address, std::make_index_sequence<sizeof...(Offsets) - 1>{}))
+				return std::nullopt;
+
+			return address + OFFSETS[sizeof...(Offsets) - 1];
+		}
+
+		template <typename T>
+		static std::optional<T> Read(const void* pBase)
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "PtrChain can only read trivially copyable types");
+
+			auto address = Resolve(pBase);
+			T value;
+
+			if (!address || !RegionMap::GetInstance().Read((const void*)*address, &value, sizeof(T)))
+				return std::nullopt;
+
+			return value;
+		}
+	private:
+		static constexpr size_t OFFSETS[] = { Offsets... };
+
+		static bool Hop(uintptr_t& address, size_t offset)
+		{
+			auto ptr = (const uintptr_t*)(address + offset);
+
+			if (!RegionMap::GetInstance().Read(ptr, &address, sizeof(uintptr_t)))
+				return false;
+
+			return address != 0;
+		}
+
+		template <size_t... I>
+		static bool Follow(uintptr_t& address, std::index_sequence<I...>)
+		{
+			return (Hop(address, OFFSETS[I]) && ...);
+		}
+	};
+}
@@ -0,0 +1,183 @@
+#include <algorithm>
+#include <mutex>
+#include <cstring>
+#include "RegionMap.hpp"
+
+namespace utility
+{
+	// No C++ objects in here, the access violation is handled without unwinding
+	static bool TryCopy(void* pBuffer, const void* ptr, size_t size)
+	{
+		__try
+		{
+			memcpy(pBuffer, ptr, size);
+			return true;
+		}
+		__except (GetExceptionCode() == EXCEPTION_ACCESS_VIOLATION ? EXCEPTION_EXECUTE_HANDLER : EXCEPTION_CONTINUE_SEARCH)
+		{
+			return false;
+		}
+	}
+
+	RegionMap::RegionMap() : regions(), mutex()
+	{
+	}
+
+	RegionMap::~RegionMap()
+	{
+	}
+
+	const RegionMap::REGION* RegionMap::Find(uintptr_t address) const
+	{
+		// First region that starts after the address, the one before it may contain it
+		auto it = std::upper_bound(regions.begin(), regions.end(), address, [](uintptr_t addr, const REGION& region) { return addr < region.begin; });
+
+		if (it == regions.begin())
+			return nullptr;
+
+		--it;
+		return address < it->end ? &*it : nullptr;
+	}
+
+	bool RegionMap::ToRegion(const MEMORY_BASIC_INFORMATION& mbi, REGION& region)
+	{
+		// Only committed memory is cached, free and reserved ranges may be committed at any time
+		if (mbi.State != MEM_COMMIT)
+			return false;
+
+		constexpr DWORD dwMask = (
+			PAGE_READONLY | PAGE_READWRITE | PAGE_WRITECOPY |
+			PAGE_EXECUTE_READ | PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY
+			);
+
+		region.begin = (uintptr_t)mbi.BaseAddress;
+		region.end = region.begin + mbi.RegionSize;
+		region.bIsReadable = !(mbi.Protect & (PAGE_GUARD | PAGE_NOACCESS)) && (mbi.Protect & dwMask);
+		region.bIsImage = mbi.Type == MEM_IMAGE;
+
+		return true;
+	}
+
+	bool RegionMap::Query(uintptr_t address, REGION& region) const
+	{
+		MEMORY_BASIC_INFORMATION mbi;
+
+		if (!::VirtualQuery((void*)address, &mbi, sizeof(MEMORY_BASIC_INFORMATION)))
+			return false;
+
+		return ToRegion(mbi, region);
+	}
+
+	bool RegionMap::Lookup(uintptr_t address, REGION& region)
+	{
+		{
+			std::shared_lock _{ mutex };
+
+			if (auto pRegion = Find(address))
+			{
+				region = *pRegion;
+				return true;
+			}
+		}
+
+		if (!Query(address, region))
+			return false;
+
+		std::unique_lock _{ mutex };
+
+		// Drop whatever the new region overlaps, those entries are stale
+		auto first = std::lower_bound(regions.begin(), regions.end(), region.begin, [](const REGION& r, uintptr_t addr) { return r.end <= addr; });
+		auto last = std::lower_bound(first, regions.end(), region.end, [](const REGION& r, uintptr_t addr) { return r.begin < addr; });
+		regions.insert(regions.erase(first, last), region);
+
+		return true;
+	}
+
+	bool RegionMap::IsReadable(const void* ptr)
+	{
+		REGION region;
+		return Lookup((uintptr_t)ptr, region) && region.bIsReadable;
+	}
+
+	bool RegionMap::IsReadable(const void* ptr, size_t size)
+	{
+		if (size == 0)
+			return IsReadable(ptr);
+
+		// The range may span several adjacent regions
+		uintptr_t address = (uintptr_t)ptr;
+		const uintptr_t end = address + size;
+
+		if (end < address)
+			return false;
+
+		REGION region;
+		while (address < end)
+		{
+			if (!Lookup(address, region) || !region.bIsReadable)
+				return false;
+
+			address = region.end;
+		}
+
+		return true;
+	}
+
+	bool RegionMap::Read(const void* ptr, void* pBuffer, size_t size)
+	{
+		if (!IsReadable(ptr, size))
+			return false;
+
+		if (TryCopy(pBuffer, ptr, size))
+			return true;
+
+		// Freed since it was cached
+		Forget((uintptr_t)ptr, (uintptr_t)ptr + size);
+
+		return false;
+	}
+
+	void RegionMap::Forget(uintptr_t begin, uintptr_t end)
+	{
+		std::unique_lock _{ mutex };
+
+		auto first = std::lower_bound(regions.begin(), regions.end(), begin, [](const REGION& r, uintptr_t addr) { return r.end <= addr; });
+		auto last = std::lower_bound(first, regions.end(), end, [](const REGION& r, uintptr_t addr) { return r.begin < addr; });
+		regions.erase(first, last);
+	}
+
+	void RegionMap::Refresh()
+	{
+		std::vector<REGION> snapshot;
+
+		SYSTEM_INFO sysInfo;
+		GetSystemInfo(&sysInfo);
+
+		REGION region;
+		MEMORY_BASIC_INFORMATION mbi;
+		auto address = (uintptr_t)sysInfo.lpMinimumApplicationAddress;
+
+		while (address < (uintptr_t)sysInfo.lpMaximumApplicationAddress && ::VirtualQuery((void*)address, &mbi, sizeof(MEMORY_BASIC_INFORMATION)))
+		{
+			if (ToRegion(mbi, region))
+				snapshot.push_back(region);
+
+			address = (uintptr_t)mbi.BaseAddress + mbi.RegionSize;
+		}
+
+		std::unique_lock _{ mutex };
+		regions = std::move(snapshot);
+	}
+
+	void RegionMap::Invalidate()
+	{
+		std::unique_lock _{ mutex };
+		regions.clear();
+	}
+
+	void RegionMap::InvalidatePrivate()
+	{
+		std::unique_lock _{ mutex };
+		std::erase_if(regions, [](const REGION& region) { return !region.bIsImage; });
+	}
+}
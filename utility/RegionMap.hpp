@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <shared_mutex>
+#include <Windows.h>
+
+namespace utility
+{
+	// Sorted snapshot of the committed regions and whether they are readable. Lookups are a binary search
+	// instead of a VirtualQuery, an address outside of the snapshot is queried once and its region added.
+	// The game decommits and frees heap memory at any time, so the private regions only live until the next
+	// InvalidatePrivate (once per sample) and Read copies under an exception handler: a stale region costs
+	// one failed read and is dropped. Call Invalidate or Refresh once modules unload.
+	class RegionMap
+	{
+	public:
+		static RegionMap& GetInstance()
+		{
+			static RegionMap instance;
+			return instance;
+		}
+
+		RegionMap();
+		virtual ~RegionMap();
+
+		RegionMap(const RegionMap& other) = delete;
+		RegionMap(RegionMap&& other) = delete;
+		RegionMap& operator=(const RegionMap& other) = delete;
+		RegionMap& operator=(RegionMap&& other) = delete;
+
+		bool IsReadable(const void* ptr);
+		bool IsReadable(const void* ptr, size_t size);
+
+		// Copies size bytes from ptr when the range is readable, survives the region being freed meanwhile
+		bool Read(const void* ptr, void* pBuffer, size_t size);
+
+		// Replaces the snapshot with every committed region of the address space
+		void Refresh();
+
+		// Drops the snapshot, regions are queried again on their next lookup
+		void Invalidate();
+
+		// Drops the heap and other private regions, the images stay
+		void InvalidatePrivate();
+	private:
+		struct REGION
+		{
+			uintptr_t begin;
+			uintptr_t end;
+			bool bIsReadable;
+			bool bIsImage;
+		};
+
+		std::vector<REGION> regions;
+		std::shared_mutex mutex;
+
+		static bool ToRegion(const MEMORY_BASIC_INFORMATION& mbi, REGION& region);
+
+		const REGION* Find(uintptr_t address) const;
+		bool Query(uintptr_t address, REGION& region) const;
+		bool Lookup(uintptr_t address, REGION& region);
+		void Forget(uintptr_t begin, uintptr_t end);
+	};
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <array>
+#include <algorithm>
+#include <cstddef>
+
+namespace utility
+{
+	// Keeps the last N samples and computes min/avg/percentiles over them
+	template <size_t N>
+	class RollingStats
+	{
+	public:
+		RollingStats() : samples(), next(0), count(0)
+		{
+		}
+
+		void Add(float value)
+		{
+			samples[next] = value;
+			next = (next + 1) % N;
+			count = std::min(count + 1, N);
+		}
+
+		void Clear()
+		{
+			next = 0;
+			count = 0;
+		}
+
+		size_t Count() const
+		{
+			return count;
+		}
+
+		// Sample i, 0 being the oldest one still kept
+		float Get(size_t i) const
+		{
+			return samples[(next + N - count + i) % N];
+		}
+
+		float GetLast() const
+		{
+			return count > 0 ? Get(count - 1) : 0.0f;
+		}
+
+		float GetMin() const
+		{
+			if (count == 0)
+				return 0.0f;
+
+			return *std::min_element(samples.begin(), samples.begin() + count);
+		}
+
+		float GetMax() const
+		{
+			if (count == 0)
+				return 0.0f;
+
+			return *std::max_element(samples.begin(), samples.begin() + count);
+		}
+
+		float GetAverage() const
+		{
+			if (count == 0)
+				return 0.0f;
+
+			float sum = 0.0f;
+			for (size_t i = 0; i < count; ++i)
+				sum += samples[i];
+
+			return sum / count;
+		}
+
+		// percentile in [0, 1], e.g. 0.99 for the p99
+		float GetPercentile(float percentile) const
+		{
+			if (count == 0)
+				return 0.0f;
+
+			std::array<float, N> sorted;
+			std::copy(samples.begin(), samples.begin() + count, sorted.begin());
+
+			auto nth = sorted.begin() + std::min((size_t)(percentile * (count - 1) + 0.5f), count - 1);
+			std::nth_element(sorted.begin(), nth, sorted.begin() + count);
+
+			return *nth;
+		}
+	private:
+		std::array<float, N> samples;
+		size_t next;
+		size_t count;
+	};
+}
@@ -0,0 +1,208 @@
+#include "ScanKernels.hpp"
+#include <bit>
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define TARGET_AVX2
+#else
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace utility
+{
+	// Bytes that show up everywhere in x64 code, a poor choice to filter candidates on.
+	static bool IsCommonByte(unsigned char b)
+	{
+		switch (b)
+		{
+			case 0x00: case 0x01: case 0x0F: case 0x24: case 0x44: case 0x48: case 0x4C: case 0x83:
+			case 0x85: case 0x89: case 0x8B: case 0x8D: case 0xC0: case 0xCC: case 0xE8: case 0xFF:
+				return true;
+		}
+		return false;
+	}
+
+	SCAN_PATTERN PreparePattern(const short* aobPattern, size_t patternCount)
+	{
+		SCAN_PATTERN pattern{};
+		pattern.size = patternCount;
+		pattern.bytes.resize(patternCount);
+		pattern.mask.resize(patternCount);
+
+		size_t firstFixed = patternCount, firstRare = patternCount, lastFixed = patternCount;
+
+		for (size_t i = 0; i < patternCount; ++i)
+		{
+			if (aobPattern[i] == -1)
+				continue;
+
+			pattern.bytes[i] = (unsigned char)aobPattern[i];
+			pattern.mask[i] = 0xFF;
+
+			if (firstFixed == patternCount)
+				firstFixed = i;
+			if (firstRare == patternCount && !IsCommonByte(pattern.bytes[i]))
+				firstRare = i;
+			lastFixed = i;
+		}
+
+		pattern.bHasFixedByte = firstFixed != patternCount;
+		pattern.anchorFirst = firstRare != patternCount ? firstRare : firstFixed;
+		pattern.anchorLast = lastFixed;
+
+		return pattern;
+	}
+
+	static inline bool VerifyScalar(const SCAN_PATTERN& pattern, const unsigned char* pMemory, size_t from)
+	{
+		for (size_t i = from; i < pattern.size; ++i)
+		{
+			if ((pMemory[i] & pattern.mask[i]) != pattern.bytes[i])
+				return false;
+		}
+		return true;
+	}
+
+	static inline bool VerifySSE2(const SCAN_PATTERN& pattern, const unsigned char* pMemory)
+	{
+		size_t i = 0;
+		for (; i + 16 <= pattern.size; i += 16)
+		{
+			__m128i mem = _mm_loadu_si128((const __m128i*)(pMemory + i));
+			__m128i msk = _mm_loadu_si128((const __m128i*)(pattern.mask.data() + i));
+			__m128i pat = _mm_loadu_si128((const __m128i*)(pattern.bytes.data() + i));
+			if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(mem, msk), pat)) != 0xFFFF)
+				return false;
+		}
+		return VerifyScalar(pattern, pMemory, i);
+	}
+
+	TARGET_AVX2 static inline bool VerifyAVX2(const SCAN_PATTERN& pattern, const unsigned char* pMemory)
+	{
+		size_t i = 0;
+		for (; i + 32 <= pattern.size; i += 32)
+		{
+			__m256i mem = _mm256_loadu_si256((const __m256i*)(pMemory + i));
+			__m256i msk = _mm256_loadu_si256((const __m256i*)(pattern.mask.data() + i));
+			__m256i pat = _mm256_loadu_si256((const __m256i*)(pattern.bytes.data() + i));
+			if ((unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(mem, msk), pat)) != 0xFFFFFFFF)
+				return false;
+		}
+		return VerifyScalar(pattern, pMemory, i);
+	}
+
+	const unsigned char* ScanScalar(const SCAN_PATTERN& pattern, const unsigned char* pBegin, const unsigned char* pEnd)
+	{
+		if ((size_t)(pEnd - pBegin) < pattern.size)
+			return nullptr;
+
+		const unsigned char* pLast = pEnd - pattern.size;
+
+		if (!pattern.bHasFixedByte)
+			return pBegin;
+
+		const unsigned char anchor = pattern.bytes[pattern.anchorFirst];
+
+		for (auto p = pBegin; p <= pLast; ++p)
+		{
+			if (p[pattern.anchorFirst] == anchor && VerifyScalar(pattern, p, 0))
+				return p;
+		}
+
+		return nullptr;
+	}
+
+	const unsigned char* ScanSSE2(const SCAN_PATTERN& pattern, const unsigned char* pBegin, const unsigned char* pEnd)
+	{
+		if ((size_t)(pEnd - pBegin) < pattern.size || !pattern.bHasFixedByte)
+			return ScanScalar(pattern, pBegin, pEnd);
+
+		const unsigned char* pLast = pEnd - pattern.size;
+		const __m128i first = _mm_set1_epi8((char)pattern.bytes[pattern.anchorFirst]);
+		const __m128i last = _mm_set1_epi8((char)pattern.bytes[pattern.anchorLast]);
+
+		// Both anchor loads (16 bytes each) stay inside the pattern window of the 16th candidate,
+		// so they never read past pEnd as long as that candidate is within range.
+		auto p = pBegin;
+		for (; p + 15 <= pLast; p += 16)
+		{
+			__m128i a = _mm_loadu_si128((const __m128i*)(p + pattern.anchorFirst));
+			__m128i b = _mm_loadu_si128((const __m128i*)(p + pattern.anchorLast));
+			unsigned int bits = (unsigned int)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last)));
+
+			while (bits != 0)
+			{
+				unsigned int idx = std::countr_zero(bits);
+				if (VerifySSE2(pattern, p + idx))
+					return p + idx;
+				bits &= bits - 1;
+			}
+		}
+
+		return ScanScalar(pattern, p, pEnd);
+	}
+
+	TARGET_AVX2 const unsigned char* ScanAVX2(const SCAN_PATTERN& pattern, const unsigned char* pBegin, const unsigned char* pEnd)
+	{
+		if ((size_t)(pEnd - pBegin) < pattern.size || !pattern.bHasFixedByte)
+			return ScanScalar(pattern, pBegin, pEnd);
+
+		const unsigned char* pLast = pEnd - pattern.size;
+		const __m256i first = _mm256_set1_epi8((char)pattern.bytes[pattern.anchorFirst]);
+		const __m256i last = _mm256_set1_epi8((char)pattern.bytes[pattern.anchorLast]);
+
+		// Every way out of the 256 bit code clears the upper halves, or the SSE code after it pays the transition
+		auto p = pBegin;
+		for (; p + 31 <= pLast; p += 32)
+		{
+			__m256i a = _mm256_loadu_si256((const __m256i*)(p + pattern.anchorFirst));
+			__m256i b = _mm256_loadu_si256((const __m256i*)(p + pattern.anchorLast));
+			unsigned int bits = (unsigned int)_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(a, first), _mm256_cmpeq_epi8(b, last)));
+
+			while (bits != 0)
+			{
+				unsigned int idx = std::countr_zero(bits);
+				if (VerifyAVX2(pattern, p + idx))
+				{
+					_mm256_zeroupper();
+					return p + idx;
+				}
+				bits &= bits - 1;
+			}
+		}
+
+		_mm256_zeroupper();
+
+		return ScanSSE2(pattern, p, pEnd);
+	}
+
+	bool IsAVX2Supported()
+	{
+#ifdef _MSC_VER
+		int info[4];
+
+		__cpuid(info, 0);
+		if (info[0] < 7)
+			return false;
+
+		// AVX + OSXSAVE, and the OS must save the YMM state
+		__cpuid(info, 1);
+		if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0)
+			return false;
+		if ((_xgetbv(0) & 0x6) != 0x6)
+			return false;
+
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#else
+		// Checks the OS support of the YMM state too
+		return __builtin_cpu_supports("avx2");
+#endif
+	}
+
+	ScanFunction GetScanFunction()
+	{
+		static const ScanFunction fnScan = IsAVX2Supported() ? ScanAVX2 : ScanSSE2;
+		return fnScan;
+	}
+}
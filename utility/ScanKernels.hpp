@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Pattern scan kernels, plain memory in and out so they build and get tested outside of Windows
+namespace utility
+{
+	// Prepared form of a short[] signature: the fixed bytes (wildcards zeroed), a byte mask
+	// (0xFF = compare, 0x00 = wildcard) and two anchor bytes used to filter candidates
+	// 16/32 offsets at a time before running the full masked compare.
+	struct SCAN_PATTERN
+	{
+		std::vector<unsigned char> bytes;
+		std::vector<unsigned char> mask;
+		size_t size;
+		size_t anchorFirst;
+		size_t anchorLast;
+		bool bHasFixedByte;
+	};
+
+	SCAN_PATTERN PreparePattern(const short* aobPattern, size_t patternCount);
+
+	// All scanners search [pBegin, pEnd) for the first offset where the whole pattern fits and matches.
+	const unsigned char* ScanScalar(const SCAN_PATTERN& pattern, const unsigned char* pBegin, const unsigned char* pEnd);
+	const unsigned char* ScanSSE2(const SCAN_PATTERN& pattern, const unsigned char* pBegin, const unsigned char* pEnd);
+	// Only call when IsAVX2Supported
+	const unsigned char* ScanAVX2(const SCAN_PATTERN& pattern, const unsigned char* pBegin, const unsigned char* pEnd);
+
+	bool IsAVX2Supported();
+
+	typedef const unsigned char* (*ScanFunction)(const SCAN_PATTERN&, const unsigned char*, const unsigned char*);
+
+	// Fastest scanner supported by the CPU
+	ScanFunction GetScanFunction();
+}
@@ -0,0 +1,371 @@
+#define NOMINMAX
+
+#include <queue>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <algorithm>
+#include <intrin.h>
+#include <emmintrin.h>
+#include <unordered_set>
+#include "Memory.hpp"
+#include "Module.hpp"
+#include "String.hpp"
+#include "SignatureSet.hpp"
+
+namespace utility
+{
+	SignatureSet::SignatureSet() : signatures(), automaton(), rootBytes(), bIsBuilt(false)
+	{
+	}
+
+	SignatureSet::~SignatureSet()
+	{
+	}
+
+	size_t SignatureSet::Add(const short* aobPattern, size_t patternSize, std::string_view section)
+	{
+		SIGNATURE sig{};
+		sig.pattern.assign(aobPattern, aobPattern + patternSize / sizeof(short));
+		sig.section = section;
+
+		// Use the longest run of fixed bytes as the automaton key
+		size_t runStart = 0, runLength = 0;
+		for (size_t i = 0; i < sig.pattern.size(); ++i)
+		{
+			if (sig.pattern[i] == -1)
+			{
+				runLength = 0;
+				continue;
+			}
+
+			if (runLength++ == 0)
+				runStart = i;
+
+			if (runLength > sig.keyLength)
+			{
+				sig.keyOffset = runStart;
+				sig.keyLength = runLength;
+			}
+		}
+
+		signatures.push_back(std::move(sig));
+		bIsBuilt = false;
+
+		return signatures.size() - 1;
+	}
+
+	void SignatureSet::Build()
+	{
+		automaton.clear();
+		automaton.emplace_back();
+		memset(automaton[0].next, -1, sizeof(NODE::next));
+
+		// Trie of the keys
+		for (size_t s = 0; s < signatures.size(); ++s)
+		{
+			auto& sig = signatures[s];
+			if (sig.keyLength == 0)
+				continue;
+
+			int state = 0;
+			for (size_t i = sig.keyOffset; i < sig.keyOffset + sig.keyLength; ++i)
+			{
+				auto b = (unsigned char)sig.pattern[i];
+				if (automaton[state].next[b] == -1)
+				{
+					automaton[state].next[b] = (int)automaton.size();
+					automaton.emplace_back();
+					memset(automaton.back().next, -1, sizeof(NODE::next));
+				}
+				state = automaton[state].next[b];
+			}
+			automaton[state].outputs.push_back(s);
+		}
+
+		// Failure links, turning the trie into a complete DFA
+		std::queue<int> nodes;
+		rootBytes.clear();
+		for (int b = 0; b < 256; ++b)
+		{
+			int child = automaton[0].next[b];
+			if (child == -1)
+			{
+				automaton[0].next[b] = 0;
+				continue;
+			}
+			rootBytes.push_back((unsigned char)b);
+			automaton[child].fail = 0;
+			nodes.push(child);
+		}
+
+		while (!nodes.empty())
+		{
+			int state = nodes.front();
+			nodes.pop();
+
+			for (int b = 0; b < 256; ++b)
+			{
+				int child = automaton[state].next[b];
+				int fallback = automaton[automaton[state].fail].next[b];
+				if (child == -1)
+				{
+					automaton[state].next[b] = fallback;
+					continue;
+				}
+
+				automaton[child].fail = fallback;
+				auto& inherited = automaton[fallback].outputs;
+				automaton[child].outputs.insert(automaton[child].outputs.end(), inherited.begin(), inherited.end());
+				nodes.push(child);
+			}
+		}
+
+		// Too many distinct first bytes make the root skip slower than walking the automaton
+		if (rootBytes.size() > MAX_ROOT_SKIP_BYTES)
+			rootBytes.clear();
+
+		bIsBuilt = true;
+	}
+
+	size_t SignatureSet::ScanRun(char* pBegin, char* pEnd, const std::vector<bool>& wanted, std::vector<char*>& matches, size_t remaining)
+	{
+		int state = 0;
+
+		for (auto p = pBegin; p < pEnd; ++p)
+		{
+			// At the root nothing is partially matched, skip 16 bytes at a time until one of them starts a key
+			if (state == 0 && !rootBytes.empty())
+			{
+				while (p + 16 <= pEnd)
+				{
+					__m128i data = _mm_loadu_si128((const __m128i*)p);
+					__m128i hits = _mm_setzero_si128();
+					for (auto b : rootBytes)
+						hits = _mm_or_si128(hits, _mm_cmpeq_epi8(data, _mm_set1_epi8((char)b)));
+
+					unsigned long idx;
+					if (_BitScanForward(&idx, (unsigned int)_mm_movemask_epi8(hits)))
+					{
+						p += idx;
+						break;
+					}
+					p += 16;
+				}
+
+				if (p >= pEnd)
+					break;
+			}
+
+			state = automaton[state].next[(unsigned char)*p];
+
+			for (auto s : automaton[state].outputs)
+			{
+				if (!wanted[s] || matches[s] != nullptr)
+					continue;
+
+				auto& sig = signatures[s];
+
+				// Matches of one signature are reported in address order, the first one is the lowest
+				char* pSig = p + 1 - sig.keyLength - sig.keyOffset;
+				if (pSig < pBegin || (size_t)(pEnd - pSig) < sig.pattern.size())
+					continue;
+
+				if (CompareByteArray(sig.pattern.data(), pSig, sig.pattern.size()))
+				{
+					matches[s] = pSig;
+					if (--remaining == 0)
+						return 0;
+				}
+			}
+		}
+
+		return remaining;
+	}
+
+	size_t SignatureSet::Prepare()
+	{
+		if (!bIsBuilt)
+			Build();
+
+		size_t remaining = 0;
+		for (auto& sig : signatures)
+		{
+			sig.pMatch = nullptr;
+			++remaining;
+		}
+
+		return remaining;
+	}
+
+	size_t SignatureSet::Scan(void* pStartAddress, size_t memorySize, std::string_view section, size_t remaining)
+	{
+		// A signature made only of wildcards matches at the very start
+		for (auto& sig : signatures)
+		{
+			if (sig.keyLength == 0 && sig.pMatch == nullptr && !sig.pattern.empty() && memorySize >= sig.pattern.size() &&
+				(section.empty() || sig.section == section))
+			{
+				sig.pMatch = (char*)pStartAddress;
+				--remaining;
+			}
+		}
+
+		if (remaining == 0)
+			return 0;
+
+		std::vector<bool> wanted(signatures.size());
+		size_t maxPatternSize = 0;
+		for (size_t i = 0; i < signatures.size(); ++i)
+		{
+			auto& sig = signatures[i];
+			wanted[i] = sig.pMatch == nullptr && (section.empty() || sig.section == section);
+			if (wanted[i])
+				maxPatternSize = std::max(maxPatternSize, sig.pattern.size());
+		}
+
+		size_t wantedCount = std::count(wanted.begin(), wanted.end(), true);
+		if (wantedCount == 0)
+			return remaining;
+
+		std::mutex mergeMutex;
+
+		ParallelForEachChunk(pStartAddress, memorySize, maxPatternSize - 1, [&](char* pBegin, char* pEnd)
+			{
+				std::vector<char*> matches(signatures.size(), nullptr);
+				ScanRun(pBegin, pEnd, wanted, matches, wantedCount);
+
+				// Keep the lowest match of each signature, chunks below this one may still be running
+				std::scoped_lock _{ mergeMutex };
+
+				bool bAllFound = true;
+				for (size_t i = 0; i < signatures.size(); ++i)
+				{
+					if (!wanted[i])
+						continue;
+
+					auto& pMatch = signatures[i].pMatch;
+					if (matches[i] != nullptr && (pMatch == nullptr || matches[i] < pMatch))
+						pMatch = matches[i];
+
+					bAllFound = bAllFound && pMatch != nullptr;
+				}
+
+				return !bAllFound;
+			});
+
+		for (size_t i = 0; i < signatures.size(); ++i)
+		{
+			if (wanted[i] && signatures[i].pMatch != nullptr)
+				--remaining;
+		}
+
+		return remaining;
+	}
+
+	bool SignatureSet::Resolve(void* pStartAddress, size_t memorySize)
+	{
+		size_t remaining = Prepare();
+
+		return Scan(pStartAddress, memorySize, {}, remaining) == 0;
+	}
+
+	bool SignatureSet::Resolve(HMODULE module)
+	{
+		size_t remaining = Prepare();
+
+		std::unordered_set<std::string_view> scannedSections;
+		for (auto& sig : signatures)
+		{
+			if (remaining == 0)
+				break;
+
+			if (!scannedSections.insert(sig.section).second)
+				continue;
+
+			auto range = GetModuleSection(module, sig.section);
+			if (!range)
+				continue;
+
+			remaining = Scan((void*)range->first, range->second, sig.section, remaining);
+		}
+
+		return remaining == 0;
+	}
+
+	size_t SignatureSet::GetHash() const
+	{
+		std::string data;
+		for (auto& sig : signatures)
+		{
+			data.append(sig.section);
+			data.push_back('\0');
+			data.append((const char*)sig.pattern.data(), sig.pattern.size() * sizeof(short));
+		}
+
+		return hash(data);
+	}
+
+	bool SignatureSet::LoadCache(HMODULE module, const std::wstring& filePath)
+	{
+		auto moduleSize = GetModuleSize(module);
+		if (!moduleSize)
+			return false;
+
+		std::ifstream file(filePath, std::ios::in);
+		if (!file)
+			return false;
+
+		auto ntHeaders = (PIMAGE_NT_HEADERS)((uintptr_t)module + ((PIMAGE_DOS_HEADER)module)->e_lfanew);
+		size_t dwTimeDateStamp = 0, dwCheckSum = 0, signaturesHash = 0, count = 0;
+
+		file >> std::hex >> dwTimeDateStamp >> dwCheckSum >> signaturesHash >> count;
+
+		if (!file || dwTimeDateStamp != ntHeaders->FileHeader.TimeDateStamp || dwCheckSum != ntHeaders->OptionalHeader.CheckSum ||
+			signaturesHash != GetHash() || count != signatures.size())
+			return false;
+
+		for (auto& sig : signatures)
+		{
+			size_t rva = 0;
+			file >> rva;
+
+			sig.pMatch = nullptr;
+
+			// Not found when the cache was written, the same build won't have it either
+			if (file && rva == 0)
+				continue;
+
+			char* pSig = (char*)module + rva;
+			if (!file || rva + sig.pattern.size() > *moduleSize || IsBadReadPtr(pSig) || IsBadReadPtr(pSig + sig.pattern.size() - 1) ||
+				!CompareByteArray(sig.pattern.data(), pSig, sig.pattern.size()))
+			{
+				Prepare();
+				return false;
+			}
+
+			sig.pMatch = pSig;
+		}
+
+		return true;
+	}
+
+	bool SignatureSet::SaveCache(HMODULE module, const std::wstring& filePath) const
+	{
+		if (!GetModuleSize(module))
+			return false;
+
+		std::ofstream file(filePath, std::ios::out | std::ios::trunc);
+		if (!file)
+			return false;
+
+		auto ntHeaders = (PIMAGE_NT_HEADERS)((uintptr_t)module + ((PIMAGE_DOS_HEADER)module)->e_lfanew);
+
+		file << std::hex << ntHeaders->FileHeader.TimeDateStamp << ' ' << ntHeaders->OptionalHeader.CheckSum << ' ' << GetHash() << ' ' << signatures.size() << std::endl;
+
+		for (auto& sig : signatures)
+			file << (sig.pMatch != nullptr ? (uintptr_t)sig.pMatch - (uintptr_t)module : 0) << std::endl;
+
+		return (bool)file;
+	}
+}
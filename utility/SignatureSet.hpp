@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <Windows.h>
+
+namespace utility
+{
+	// Resolves any number of short[] signatures with a single pass over memory, split across worker threads.
+	// The longest run of fixed bytes of each signature is fed into an Aho-Corasick automaton,
+	// every automaton hit is then verified against the whole signature.
+	class SignatureSet
+	{
+	public:
+		SignatureSet();
+		virtual ~SignatureSet();
+
+		// Returns the index used to fetch the match with Get().
+		// section is only used by Resolve(HMODULE): ".text" for code, ".rdata" for vtables and strings.
+		size_t Add(const short* aobPattern, size_t patternSize, std::string_view section = ".text");
+
+		// Scans the memory once, ignoring the sections, returns true when every signature was found.
+		bool Resolve(void* pStartAddress, size_t memorySize);
+
+		// Scans each section of the module used by a signature once, returns true when every signature was found.
+		bool Resolve(HMODULE module);
+
+		// Restores the matches saved by SaveCache when the file was written for the same build of the module
+		// and the same signatures, the bytes at every cached match are verified again.
+		// Returns true when every signature was restored, the ones that were not found when saving stay null.
+		bool LoadCache(HMODULE module, const std::wstring& filePath);
+		bool SaveCache(HMODULE module, const std::wstring& filePath) const;
+
+		char* Get(size_t index) const
+		{
+			return index < signatures.size() ? signatures[index].pMatch : nullptr;
+		}
+
+		size_t Size() const
+		{
+			return signatures.size();
+		}
+	private:
+		static constexpr size_t MAX_ROOT_SKIP_BYTES = 8;
+
+		struct SIGNATURE
+		{
+			std::vector<short> pattern;
+			std::string section;
+			size_t keyOffset;
+			size_t keyLength;
+			char* pMatch;
+		};
+
+		struct NODE
+		{
+			int next[256];
+			int fail;
+			std::vector<size_t> outputs;
+		};
+
+		std::vector<SIGNATURE> signatures;
+		std::vector<NODE> automaton;
+		std::vector<unsigned char> rootBytes;
+		bool bIsBuilt;
+
+		void Build();
+		size_t GetHash() const;
+		size_t Prepare();
+		size_t Scan(void* pStartAddress, size_t memorySize, std::string_view section, size_t remaining);
+		size_t ScanRun(char* pBegin, char* pEnd, const std::vector<bool>& wanted, std::vector<char*>& matches, size_t remaining);
+	};
+}
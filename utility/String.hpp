@@ -25,6 +25,18 @@ namespace utility {
 
         return result;
     }
+
+    // FNV-1a over raw bytes, pass the previous result as seed to hash several buffers together
+    static inline size_t hash(const void* data, size_t size, size_t seed = 0xcbf29ce484222325) {
+        size_t result = seed;
+
+        for (size_t i = 0; i < size; ++i) {
+            result ^= ((const unsigned char*)data)[i];
+            result *= (size_t)1099511628211;
+        }
+
+        return result;
+    }
 }
 
 consteval auto operator "" _fnv(const char* s, size_t) {
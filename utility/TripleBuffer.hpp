@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace utility
+{
+	// Wait-free handoff of the latest value from one writer thread to one reader thread.
+	// The writer fills GetWriteBuffer() and calls Publish(), the reader always gets the most recent
+	// published value from GetReadBuffer() and never sees a buffer while it is being written.
+	template <typename T>
+	class TripleBuffer
+	{
+	public:
+		TripleBuffer() : buffers(), middle(1), writeIndex(0), readIndex(2)
+		{
+		}
+
+		TripleBuffer(const TripleBuffer& other) = delete;
+		TripleBuffer& operator=(const TripleBuffer& other) = delete;
+
+		// Writer side, the buffer holds whatever was published two writes ago
+		T& GetWriteBuffer()
+		{
+			return buffers[writeIndex].value;
+		}
+
+		void Publish()
+		{
+			writeIndex = middle.exchange(writeIndex | NEW_DATA_BIT, std::memory_order_acq_rel) & INDEX_MASK;
+		}
+
+		// Reader side, the reference stays valid until the next call
+		const T& GetReadBuffer()
+		{
+			if (middle.load(std::memory_order_relaxed) & NEW_DATA_BIT)
+				readIndex = middle.exchange(readIndex, std::memory_order_acq_rel) & INDEX_MASK;
+
+			return buffers[readIndex].value;
+		}
+	private:
+		static constexpr uint8_t INDEX_MASK = 0x3;
+		static constexpr uint8_t NEW_DATA_BIT = 0x4;
+
+		// Writer and reader work on different cache lines
+		struct alignas(64) SLOT
+		{
+			T value;
+		};
+
+		SLOT buffers[3];
+		std::atomic<uint8_t> middle;
+		uint8_t writeIndex;
+		alignas(64) uint8_t readIndex;
+	};
+}